@@ -1,5 +1,5 @@
 #type vertex
-#version 450 core
+#version 330 core
 
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec4 fill_color;
@@ -15,11 +15,13 @@ void main()
 }
 
 #type fragment
-#version 450 core
+#version 330 core
 
-layout(location = 0) in vec4 v_fill_color;
+in vec4 v_fill_color;
+
+layout(location = 0) out vec4 fragment_color;
 
 void main()
 {
-    gl_FragColor = v_fill_color;
+    fragment_color = v_fill_color;
 }
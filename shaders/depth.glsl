@@ -0,0 +1,22 @@
+#type vertex
+#version 330 core
+
+#include "chunk_vertex.glsl"
+
+#type fragment
+#version 330 core
+
+in vec2 v_uv;
+flat in int v_layer;
+flat in int v_tint;
+flat in vec3 v_tint_color;
+flat in int v_is_cutout;
+
+#include "block_texture.glsl"
+
+// Only writes depth, but still has to discard the texels the opaque pass discards so that what is behind them passes its equal depth test
+void main()
+{
+    if (!is_opaque_block_texel(tint_block_texture(sample_block_texture(v_uv, v_layer), v_tint, v_tint_color).a, v_is_cutout))
+        discard;
+}
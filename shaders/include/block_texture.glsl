@@ -0,0 +1,35 @@
+#include "tint.glsl"
+
+uniform sampler2DArray block_textures;
+
+// Filtering blends the edges of cutout textures, texels are kept from the point where they are at least half opaque. Has to match MIP_ALPHA_CUTOFF
+const float ALPHA_CUTOFF = 0.5;
+// Translucent textures keep their alpha for blending and only lose texels that are fully transparent
+const float TRANSLUCENT_ALPHA_CUTOFF = 1.0 / 255.0;
+
+vec4 sample_block_texture(vec2 uv, int layer)
+{
+    return texture(block_textures, vec3(uv, float(layer)));
+}
+
+// Texels drawn by the opaque passes, which write depth. Translucent texels are left to the translucent pass, so that they never hide what is behind them
+bool is_opaque_block_texel(float alpha, int is_cutout)
+{
+    return alpha >= (is_cutout != 0 ? ALPHA_CUTOFF : 1.0);
+}
+
+// Texels drawn by the translucent pass, which blends them over the opaque passes without writing depth
+bool is_translucent_block_texel(float alpha, int is_cutout)
+{
+    return is_cutout == 0 && alpha >= TRANSLUCENT_ALPHA_CUTOFF && alpha < 1.0;
+}
+
+// Overlay textures are opaque, their alpha only marks where the colour applies
+vec4 tint_block_texture(vec4 color, int tint, vec3 tint_color)
+{
+    if (tint == TINT_GRASS_OVERLAY)
+        return vec4(mix(color.rgb, color.rgb * tint_color, color.a), 1.0);
+    if (tint != TINT_NONE)
+        color.rgb *= tint_color;
+    return color;
+}
@@ -0,0 +1,64 @@
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec2 uv;
+layout(location = 2) in float texture_index;
+// xyz: integer position of the chunk in blocks, w: level of detail scaling its blocks by 2^w
+layout(location = 3) in ivec4 chunk_origin;
+layout(location = 4) in int face;
+layout(location = 5) in int biome;
+
+out vec2 v_uv;
+flat out int v_layer;
+flat out int v_tint;
+flat out vec3 v_tint_color;
+flat out int v_is_cutout;
+
+// Texture array layer of every face of every block texture cubemap in the low 16 bits and its tint above, indexed by cubemap * 6 + face. Animated faces
+// hold the index of their animation instead of a layer, the layers of their frames follow the faces
+uniform isamplerBuffer face_layers;
+
+// Have to match FACE_ANIMATED_BIT, FACE_CUTOUT_BIT and MAX_TEXTURE_ANIMATIONS
+const int FACE_ANIMATED_BIT = 1 << 24;
+const int FACE_CUTOUT_BIT = 1 << 25;
+const int MAX_TEXTURE_ANIMATIONS = 1024;
+const float TICKS_PER_SECOND = 20.0;
+
+// x: index of the layer of the first frame in the face table, y: number of frames, z: ticks per frame. Bound to uniform buffer binding 0
+layout(std140) uniform TextureAnimations
+{
+    ivec4 texture_animations[MAX_TEXTURE_ANIMATIONS];
+};
+
+// In seconds, animations are a function of it alone
+uniform float time;
+
+#include "tint.glsl"
+
+// Grass colours in row 0 and foliage colours in row 1, one column per biome
+uniform sampler2D biome_colors;
+
+// Every program drawing chunks has to compute the exact same depth for the depth pre-pass to work
+invariant gl_Position;
+
+uniform mat4 MVP;
+
+void main()
+{
+    float scale = float(1 << chunk_origin.w) / 16.0;
+    gl_Position = MVP * vec4(vec3(chunk_origin.xyz) + position * scale, 1.0);
+    v_uv = uv;
+
+    int entry = texelFetch(face_layers, int(texture_index) * 6 + face).r;
+    v_tint = (entry >> 16) & 0xFF;
+    v_is_cutout = (entry & FACE_CUTOUT_BIT) != 0 ? 1 : 0;
+    if ((entry & FACE_ANIMATED_BIT) != 0)
+    {
+        ivec4 animation = texture_animations[entry & 0xFFFF];
+        int frame = int(time * TICKS_PER_SECOND) / animation.z % animation.y;
+        v_layer = texelFetch(face_layers, animation.x + frame).r;
+    }
+    else
+    {
+        v_layer = entry & 0xFFFF;
+    }
+    v_tint_color = texelFetch(biome_colors, ivec2(biome, v_tint == TINT_FOLIAGE ? 1 : 0), 0).rgb;
+}
@@ -0,0 +1,5 @@
+// Has to match the TextureTint enum
+const int TINT_NONE = 0;
+const int TINT_GRASS = 1;
+const int TINT_FOLIAGE = 2;
+const int TINT_GRASS_OVERLAY = 3;
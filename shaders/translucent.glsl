@@ -0,0 +1,25 @@
+#type vertex
+#version 330 core
+
+#include "chunk_vertex.glsl"
+
+#type fragment
+#version 330 core
+
+in vec2 v_uv;
+flat in int v_layer;
+flat in int v_tint;
+flat in vec3 v_tint_color;
+flat in int v_is_cutout;
+
+layout(location = 0) out vec4 fragment_color;
+
+#include "block_texture.glsl"
+
+void main()
+{
+    fragment_color = tint_block_texture(sample_block_texture(v_uv, v_layer), v_tint, v_tint_color);
+
+    if (!is_translucent_block_texel(fragment_color.a, v_is_cutout))
+        discard;
+}
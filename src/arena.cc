@@ -0,0 +1,240 @@
+#include "arena.h"
+
+#include "buffer.h"
+#include "state_cache.h"
+
+namespace rb
+{
+
+namespace utils
+{
+
+// Buffers are never resized in place, so with direct state access they can have immutable storage
+static BufferObject create_arena_buffer(GLsizeiptr size)
+{
+    BufferObject buffer = create_buffer();
+    buffer.set_size(size);
+
+    if (GLAD_GL_VERSION_4_5)
+    {
+        glNamedBufferStorage(buffer.get_id(), size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+        return buffer;
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.get_id());
+    glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    return buffer;
+}
+
+}  // namespace utils
+
+BufferArena::BufferArena(int element_size, int capacity)
+  : element_size(element_size), capacity(capacity), num_free_elements(capacity), id(utils::create_arena_buffer(static_cast<GLsizeiptr>(capacity) * element_size))
+{
+    this->free_ranges[0] = capacity;
+}
+
+int BufferArena::allocate(int num_elements)
+{
+    int offset = this->take_free_range(num_elements);
+
+    if (offset < 0)
+    {
+        // Compacting is enough if the free space is only fragmented, otherwise the buffer has to grow
+        if (this->num_free_elements >= num_elements)
+            this->relocate(this->capacity);
+        else
+            this->relocate(std::max(this->capacity * 2, this->capacity - this->num_free_elements + num_elements));
+
+        offset = this->take_free_range(num_elements);
+    }
+
+    int handle;
+    if (!this->free_handles.empty())
+    {
+        handle = this->free_handles.back();
+        this->free_handles.pop_back();
+    }
+    else
+    {
+        handle = this->allocations.size();
+        this->allocations.emplace_back();
+    }
+
+    this->allocations[handle] = {offset, num_elements};
+    return handle;
+}
+
+void BufferArena::free(int handle)
+{
+    Range range = this->allocations[handle];
+    this->allocations[handle] = {0, 0};
+    this->free_handles.push_back(handle);
+    this->num_free_elements += range.size;
+
+    const auto next = this->free_ranges.lower_bound(range.offset);
+    if (next != this->free_ranges.end() && range.offset + range.size == next->first)
+    {
+        range.size += next->second;
+        this->free_ranges.erase(next);
+    }
+
+    const auto next_after_merge = this->free_ranges.lower_bound(range.offset);
+    if (next_after_merge != this->free_ranges.begin())
+    {
+        const auto previous = std::prev(next_after_merge);
+        if (previous->first + previous->second == range.offset)
+        {
+            previous->second += range.size;
+            return;
+        }
+    }
+
+    this->free_ranges[range.offset] = range.size;
+}
+
+void BufferArena::write(int handle, const void* data) const
+{
+    const Range& range = this->allocations[handle];
+    write_buffer(this->id.get_id(), static_cast<GLintptr>(range.offset) * this->element_size, static_cast<GLsizeiptr>(range.size) * this->element_size, data);
+}
+
+void BufferArena::defragment()
+{
+    this->relocate(this->capacity);
+}
+
+void BufferArena::set_relocation_callback(std::function<void()> callback)
+{
+    this->relocation_callback = std::move(callback);
+}
+
+int BufferArena::get_offset(int handle) const
+{
+    return this->allocations[handle].offset;
+}
+
+GLuint BufferArena::get_id() const
+{
+    return this->id.get_id();
+}
+
+int BufferArena::get_generation() const
+{
+    return this->generation;
+}
+
+int BufferArena::take_free_range(int num_elements)
+{
+    for (auto range = this->free_ranges.begin(); range != this->free_ranges.end(); ++range)
+    {
+        if (range->second < num_elements) continue;
+
+        const auto [offset, size] = *range;
+        this->free_ranges.erase(range);
+        if (size > num_elements) this->free_ranges[offset + num_elements] = size - num_elements;
+
+        this->num_free_elements -= num_elements;
+        return offset;
+    }
+
+    return -1;
+}
+
+void BufferArena::relocate(int new_capacity)
+{
+    if (this->relocation_callback) this->relocation_callback();
+
+    BufferObject new_buffer = utils::create_arena_buffer(static_cast<GLsizeiptr>(new_capacity) * this->element_size);
+
+    if (!GLAD_GL_VERSION_4_5)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, this->id.get_id());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, new_buffer.get_id());
+    }
+
+    std::vector<int> handles;
+    for (int handle = 0; handle < this->allocations.size(); ++handle)
+        if (this->allocations[handle].size > 0) handles.push_back(handle);
+    std::sort(handles.begin(), handles.end(), [this](int a, int b) { return this->allocations[a].offset < this->allocations[b].offset; });
+
+    int end = 0;
+    for (const int handle : handles)
+    {
+        Range& range = this->allocations[handle];
+        const GLintptr read_offset = static_cast<GLintptr>(range.offset) * this->element_size;
+        const GLintptr write_offset = static_cast<GLintptr>(end) * this->element_size;
+        const GLsizeiptr size = static_cast<GLsizeiptr>(range.size) * this->element_size;
+
+        if (GLAD_GL_VERSION_4_5)
+            glCopyNamedBufferSubData(this->id.get_id(), new_buffer.get_id(), read_offset, write_offset, size);
+        else
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, read_offset, write_offset, size);
+        range.offset = end;
+        end += range.size;
+    }
+
+    this->id = std::move(new_buffer);
+    ++this->generation;
+    this->capacity = new_capacity;
+    this->num_free_elements = new_capacity - end;
+
+    this->free_ranges.clear();
+    if (this->num_free_elements > 0) this->free_ranges[end] = this->num_free_elements;
+}
+
+GeometryArena::GeometryArena(int vertex_capacity, int index_capacity)
+  : vertices(sizeof(Vertex), vertex_capacity), indices(sizeof(Index), index_capacity), vao(create_vertex_array())
+{ }
+
+void GeometryArena::reserve_quads(int num_quads)
+{
+    if (num_quads <= this->num_quads) return;
+
+    this->num_quads = std::max(num_quads, this->num_quads * 2);
+    if (this->quad_indices >= 0) this->indices.free(this->quad_indices);
+
+    this->quad_indices = this->indices.allocate(this->num_quads * 6);
+    this->indices.write(this->quad_indices, generate_quad_indices(this->num_quads).data());
+}
+
+int GeometryArena::get_quad_indices_offset() const
+{
+    return this->indices.get_offset(this->quad_indices);
+}
+
+void GeometryArena::update_vertex_array()
+{
+    if (this->vertices.get_generation() != this->vertices_generation)
+    {
+        this->vertices_generation = this->vertices.get_generation();
+        set_vertex_attributes(this->vao.get_id(), this->vertices.get_id());
+    }
+
+    if (this->indices.get_generation() != this->indices_generation)
+    {
+        this->indices_generation = this->indices.get_generation();
+
+        if (GLAD_GL_VERSION_4_5)
+        {
+            glVertexArrayElementBuffer(this->vao.get_id(), this->indices.get_id());
+        }
+        else
+        {
+            StateCache::get_current()->bind_vertex_array(this->vao.get_id());
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->indices.get_id());
+        }
+    }
+}
+
+void GeometryArena::set_chunk_origin_buffer(GLuint buffer)
+{
+    set_chunk_origin_attributes(this->vao.get_id(), buffer);
+}
+
+GLuint GeometryArena::get_vertex_array() const
+{
+    return this->vao.get_id();
+}
+
+}  // namespace rb
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "constants.h"
+#include "glad/glad.h"
+#include "object.h"
+#include "vertex.h"
+
+namespace rb
+{
+
+// Sub-allocates ranges of one large buffer from a first-fit free list, all offsets and sizes are counted in elements
+class BufferArena
+{
+public:
+    BufferArena(int element_size, int capacity);
+
+    // Returns a handle to a range of the given number of elements, compacting or growing the buffer if no free range is large enough
+    int allocate(int num_elements);
+    void free(int handle);
+    void write(int handle, const void* data) const;
+
+    // Moves all allocated ranges to the start of the buffer, which changes their offsets
+    void defragment();
+    // Called before the buffer is replaced, which must not happen while another context is still writing to it
+    void set_relocation_callback(std::function<void()> callback);
+
+    int get_offset(int handle) const;
+    GLuint get_id() const;
+    // Incremented whenever the buffer is replaced, as its new name may be one that an earlier buffer had
+    int get_generation() const;
+
+private:
+    struct Range
+    {
+        int offset;
+        int size;
+    };
+
+    int take_free_range(int num_elements);
+    void relocate(int new_capacity);
+
+    int element_size;
+    int capacity;
+    int num_free_elements;
+    BufferObject id;
+    int generation = 0;
+
+    std::vector<Range> allocations;
+    std::vector<int> free_handles;
+    // Free ranges by offset, adjacent ranges are always merged
+    std::map<int, int> free_ranges;
+
+    std::function<void()> relocation_callback;
+};
+
+// Vertices and indices of all chunk meshes, drawn through a single vertex array
+class GeometryArena
+{
+public:
+    GeometryArena(int vertex_capacity, int index_capacity);
+
+    // Grows the shared quad index range to hold at least the given number of quads
+    void reserve_quads(int num_quads);
+    int get_quad_indices_offset() const;
+    // Sets the buffer the per draw chunk origins are read from
+    void set_chunk_origin_buffer(GLuint buffer);
+
+    // Points the vertex array at the buffers of the arenas if they were replaced since the last call, which without direct state access leaves it bound
+    void update_vertex_array();
+    GLuint get_vertex_array() const;
+
+    BufferArena vertices;
+    BufferArena indices;
+
+private:
+    VertexArrayObject vao;
+    int vertices_generation = -1;
+    int indices_generation = -1;
+
+    int quad_indices = -1;
+    int num_quads = 0;
+};
+
+}  // namespace rb
@@ -0,0 +1,66 @@
+#include "biome.h"
+
+#include "state_cache.h"
+
+namespace rb
+{
+
+// Grass and foliage colours as 0xRRGGBB, in the order of the Biome enum
+static constexpr std::array<std::array<std::uint32_t, NUM_BIOME_COLORS>, NUM_BIOMES> BIOME_COLORS = {{
+    {0x91BD59, 0x77AB2F},
+    {0x79C05A, 0x59AE30},
+    {0x88BB67, 0x6BA941},
+    {0x507A32, 0x59AE30},
+    {0x86B87F, 0x68A464},
+    {0x80B497, 0x60A17B},
+    {0x59C93C, 0x30BB0B},
+    {0x6A7039, 0x6A7039},
+    {0xBFB755, 0xAEA42A},
+    {0xBFB755, 0xAEA42A},
+    {0x90814D, 0x9E814D},
+    {0x55C93F, 0x2BBB0F},
+}};
+
+BiomeColorMap::BiomeColorMap()
+{
+    // One row per colour and one column per biome, stored as bytes in RGBA order
+    std::array<std::uint8_t, NUM_BIOMES * NUM_BIOME_COLORS * 4> texels;
+    for (int color = 0; color < NUM_BIOME_COLORS; ++color)
+        for (int biome = 0; biome < NUM_BIOMES; ++biome)
+        {
+            const std::uint32_t rgb = BIOME_COLORS[biome][color];
+            std::uint8_t* texel = &texels[(color * NUM_BIOMES + biome) * 4];
+            texel[0] = rgb >> 16;
+            texel[1] = (rgb >> 8) & 0xFF;
+            texel[2] = rgb & 0xFF;
+            texel[3] = 0xFF;
+        }
+
+    GLuint id;
+    if (GLAD_GL_VERSION_4_5)
+        glCreateTextures(GL_TEXTURE_2D, 1, &id);
+    else
+        glGenTextures(1, &id);
+    this->id = TextureObject {id};
+    this->id.set_size(texels.size());
+
+    // Only ever read with texelFetch, so filtering does not matter
+    if (GLAD_GL_VERSION_4_5)
+    {
+        glTextureStorage2D(id, 1, GL_RGBA8, NUM_BIOMES, NUM_BIOME_COLORS);
+        glTextureSubImage2D(id, 0, 0, 0, NUM_BIOMES, NUM_BIOME_COLORS, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+    }
+    else
+    {
+        StateCache::get_current()->bind_texture(0, GL_TEXTURE_2D, id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, NUM_BIOMES, NUM_BIOME_COLORS, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+    }
+}
+
+GLuint BiomeColorMap::get_id() const
+{
+    return this->id.get_id();
+}
+
+}  // namespace rb
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "object.h"
+
+namespace rb
+{
+
+enum class Biome
+{
+    PLAINS,
+    FOREST,
+    BIRCH_FOREST,
+    DARK_FOREST,
+    TAIGA,
+    SNOWY_TUNDRA,
+    JUNGLE,
+    SWAMP,
+    SAVANNA,
+    DESERT,
+    BADLANDS,
+    MUSHROOM_FIELDS,
+};
+
+static constexpr int NUM_BIOMES = 12;
+
+// Rows of the biome colour map, which tinted textures select their colour from
+enum class BiomeColor
+{
+    GRASS,
+    FOLIAGE,
+};
+
+static constexpr int NUM_BIOME_COLORS = 2;
+
+// How the biome colours a face texture. Greyscale textures are multiplied by the colour, overlay textures such as the sides of grass blocks only where
+// their alpha marks the overlay, as they are otherwise opaque
+enum class TextureTint
+{
+    NONE,
+    GRASS,
+    FOLIAGE,
+    GRASS_OVERLAY,
+};
+
+// Grass and foliage colour of every biome as one texel per biome and colour, so that one greyscale texture serves every biome
+class BiomeColorMap
+{
+public:
+    BiomeColorMap();
+
+    GLuint get_id() const;
+
+private:
+    TextureObject id;
+};
+
+}  // namespace rb
@@ -1,42 +1,112 @@
 #include "buffer.h"
 
+#include "state_cache.h"
 #include "vertex.h"
 
 namespace rb
 {
 
-VertexBuffer::VertexBuffer(GLsizeiptr size, const void* data)
+BufferObject create_buffer()
 {
-    glGenVertexArrays(1, &this->vao);
-    glBindVertexArray(this->vao);
+    GLuint buffer;
+    if (GLAD_GL_VERSION_4_5)
+        glCreateBuffers(1, &buffer);
+    else
+        glGenBuffers(1, &buffer);
+    return BufferObject {buffer};
+}
+
+VertexArrayObject create_vertex_array()
+{
+    GLuint vao;
+    if (GLAD_GL_VERSION_4_5)
+        glCreateVertexArrays(1, &vao);
+    else
+        glGenVertexArrays(1, &vao);
+    return VertexArrayObject {vao};
+}
+
+void write_buffer(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    if (GLAD_GL_VERSION_4_5)
+    {
+        glNamedBufferSubData(buffer, offset, size, data);
+        return;
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+}
 
-    glGenBuffers(1, &this->vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
-    glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+void set_vertex_attributes(GLuint vao, GLuint vbo)
+{
+    if (GLAD_GL_VERSION_4_5)
+    {
+        glVertexArrayVertexBuffer(vao, 0, vbo, 0, sizeof(Vertex));
+
+        glEnableVertexArrayAttrib(vao, 0);
+        glVertexArrayAttribFormat(vao, 0, 3, GL_UNSIGNED_SHORT, GL_FALSE, offsetof(Vertex, position));
+        glVertexArrayAttribBinding(vao, 0, 0);
+        glEnableVertexArrayAttrib(vao, 1);
+        glVertexArrayAttribFormat(vao, 1, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, uv));
+        glVertexArrayAttribBinding(vao, 1, 0);
+        glEnableVertexArrayAttrib(vao, 2);
+        glVertexArrayAttribFormat(vao, 2, 1, GL_FLOAT, GL_FALSE, offsetof(Vertex, texture_index));
+        glVertexArrayAttribBinding(vao, 2, 0);
+        glEnableVertexArrayAttrib(vao, 4);
+        glVertexArrayAttribIFormat(vao, 4, 1, GL_UNSIGNED_SHORT, offsetof(Vertex, face));
+        glVertexArrayAttribBinding(vao, 4, 0);
+        return;
+    }
+
+    StateCache::get_current()->bind_vertex_array(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
 
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, position));
+    glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, position));
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, im_coords));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, uv));
     glEnableVertexAttribArray(2);
     glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, texture_index));
+    glEnableVertexAttribArray(4);
+    glVertexAttribIPointer(4, 1, GL_UNSIGNED_SHORT, sizeof(Vertex), (const void*)offsetof(Vertex, face));
 }
 
-void VertexBuffer::bind() const
+void set_chunk_origin_attributes(GLuint vao, GLuint buffer, GLintptr offset)
 {
-    glBindVertexArray(this->vao);
-}
+    if (GLAD_GL_VERSION_4_5)
+    {
+        glVertexArrayVertexBuffer(vao, 1, buffer, offset, sizeof(ChunkOrigin));
+        glVertexArrayBindingDivisor(vao, 1, 1);
 
-IndexBuffer::IndexBuffer(GLsizeiptr size, const void* data)
-{
-    glGenBuffers(1, &this->ibo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+        glEnableVertexArrayAttrib(vao, 3);
+        glVertexArrayAttribIFormat(vao, 3, 4, GL_INT, offsetof(ChunkOrigin, position));
+        glVertexArrayAttribBinding(vao, 3, 1);
+        glEnableVertexArrayAttrib(vao, 5);
+        glVertexArrayAttribIFormat(vao, 5, 1, GL_INT, offsetof(ChunkOrigin, biome));
+        glVertexArrayAttribBinding(vao, 5, 1);
+        return;
+    }
+
+    StateCache::get_current()->bind_vertex_array(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+    glEnableVertexAttribArray(3);
+    glVertexAttribIPointer(3, 4, GL_INT, sizeof(ChunkOrigin), (const void*)(offset + offsetof(ChunkOrigin, position)));
+    glVertexAttribDivisor(3, 1);
+    glEnableVertexAttribArray(5);
+    glVertexAttribIPointer(5, 1, GL_INT, sizeof(ChunkOrigin), (const void*)(offset + offsetof(ChunkOrigin, biome)));
+    glVertexAttribDivisor(5, 1);
 }
 
-void IndexBuffer::bind() const
+std::vector<Index> generate_quad_indices(int num_quads)
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ibo);
+    static constexpr std::array<Index, 6> QUAD_INDICES = {0, 1, 2, 2, 3, 0};
+
+    std::vector<Index> indices(num_quads * 6);
+    for (int i = 0; i < num_quads * 6; ++i)
+        indices[i] = QUAD_INDICES[i % 6] + (i / 6) * 4;
+    return indices;
 }
 
 }  // namespace rb
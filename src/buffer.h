@@ -1,30 +1,24 @@
 #pragma once
 
+#include "constants.h"
 #include "glad/glad.h"
+#include "object.h"
 
 namespace rb
 {
 
-class VertexBuffer
-{
-public:
-    VertexBuffer(GLsizeiptr size, const void* data);
-
-    void bind() const;
-
-private:
-    GLuint vao, vbo;
-};
-
-class IndexBuffer
-{
-public:
-    IndexBuffer(GLsizeiptr size, const void* data);
-
-    void bind() const;
-
-private:
-    GLuint ibo;
-};
+// Create objects that with direct state access are initialized without binding them
+BufferObject create_buffer();
+VertexArrayObject create_vertex_array();
+// Writes to part of a buffer without changing any binding used for drawing
+void write_buffer(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+// Points the vertex array at the buffer and describes the layout of Vertex to it, which leaves both bound on contexts without direct state access
+void set_vertex_attributes(GLuint vao, GLuint vbo);
+// Points the vertex array at a buffer of ChunkOrigins advancing once per instance, with the same binding behaviour as set_vertex_attributes. The offset in
+// bytes selects the first origin for contexts that can't draw with a base instance
+void set_chunk_origin_attributes(GLuint vao, GLuint buffer, GLintptr offset = 0);
+
+// Indices 0, 1, 2, 2, 3, 0 offset by 4 for every quad
+std::vector<Index> generate_quad_indices(int num_quads);
 
 }  // namespace rb
@@ -0,0 +1,235 @@
+#include "bundle.h"
+
+#include "image.h"
+#include "mipmap.h"
+#include "pool.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rb
+{
+
+static constexpr std::array<const char*, 2> BUNDLE_IMAGE_EXTENSIONS = {".png", ".tga"};
+static constexpr std::size_t BUNDLE_PIXELS_ALIGNMENT = 16;
+// Far beyond any block texture, but keeps the size of a mip chain from overflowing
+static constexpr std::uint32_t MAX_BUNDLE_TEXTURE_SIZE = 1 << 14;
+
+namespace utils
+{
+
+// Written so that offsets and lengths read from a damaged file can't overflow
+static bool is_range_within(std::uint64_t offset, std::uint64_t length, std::uint64_t size)
+{
+    return offset <= size && length <= size - offset;
+}
+
+}  // namespace utils
+
+TextureBundle::TextureBundle(const std::string& filepath)
+{
+    const int file = open(filepath.c_str(), O_RDONLY);
+    if (file < 0) return;
+
+    struct stat file_status;
+    if (fstat(file, &file_status) || file_status.st_size < static_cast<off_t>(sizeof(Header)))
+    {
+        std::cerr << "Failed to open texture bundle: file \"" << filepath << "\" is too small\n";
+        close(file);
+        return;
+    }
+
+    // The mapping stays valid after closing the file
+    void* mapping = mmap(nullptr, file_status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "Failed to open texture bundle: file \"" << filepath << "\" could not be mapped\n";
+        return;
+    }
+
+    this->mapping = static_cast<const std::uint8_t*>(mapping);
+    this->mapping_size = file_status.st_size;
+
+    const Header* header = reinterpret_cast<const Header*>(this->mapping);
+
+    if (std::memcmp(header->magic, TEXTURE_BUNDLE_MAGIC, sizeof(TEXTURE_BUNDLE_MAGIC)))
+        std::cerr << "Failed to open texture bundle: file \"" << filepath << "\" is not a texture bundle\n";
+
+    else if (header->version != TEXTURE_BUNDLE_VERSION)
+        std::cerr << "Failed to open texture bundle: \"" << filepath << "\" is of version " << header->version << " instead of " << TEXTURE_BUNDLE_VERSION
+                  << ", bake it again\n";
+
+    else if (header->format != TextureBundleFormat::RGBA8 || header->texture_size == 0 || header->texture_size > MAX_BUNDLE_TEXTURE_SIZE
+             || header->num_levels != get_num_mip_levels(header->texture_size))
+        std::cerr << "Failed to open texture bundle: format of \"" << filepath << "\" is not supported\n";
+
+    else if (!utils::is_range_within(header->index_offset, static_cast<std::uint64_t>(header->num_textures) * sizeof(IndexEntry), this->mapping_size)
+             || header->names_offset > header->pixels_offset || header->pixels_offset > this->mapping_size)
+        std::cerr << "Failed to open texture bundle: \"" << filepath << "\" is truncated\n";
+
+    else if (!this->is_index_valid(*header))
+        std::cerr << "Failed to open texture bundle: index of \"" << filepath << "\" is damaged\n";
+
+    else
+    {
+        this->header = header;
+        this->index = reinterpret_cast<const IndexEntry*>(this->mapping + header->index_offset);
+        this->directory = std::filesystem::path {filepath}.lexically_normal().parent_path();
+    }
+}
+
+TextureBundle::~TextureBundle()
+{
+    if (this->mapping) munmap(const_cast<std::uint8_t*>(this->mapping), this->mapping_size);
+}
+
+bool TextureBundle::bake(const std::string& pack_path, const std::string& filepath, int texture_size)
+{
+    std::error_code error;
+    std::filesystem::recursive_directory_iterator entries {pack_path + "/textures", error};
+    if (error)
+    {
+        std::cerr << "Failed to bake texture bundle: resource pack \"" << pack_path << "\" has no textures directory\n";
+        return false;
+    }
+
+    std::vector<std::string> names;
+    for (const auto& entry : entries)
+    {
+        const std::string extension = entry.path().extension().string();
+        if (entry.is_regular_file() && std::find(BUNDLE_IMAGE_EXTENSIONS.begin(), BUNDLE_IMAGE_EXTENSIONS.end(), extension) != BUNDLE_IMAGE_EXTENSIONS.end())
+            names.push_back(entry.path().lexically_relative(pack_path).generic_string());
+    }
+    std::sort(names.begin(), names.end());
+
+    // Images are decoded in parallel into their slots, images of other sizes such as flipbooks are left out afterwards
+    const std::size_t chain_size = get_mip_chain_size(texture_size);
+    std::vector<std::uint8_t> pixels(chain_size * names.size());
+    std::vector<char> is_included(names.size());
+    {
+        ThreadPool thread_pool;
+        for (std::size_t i = 0; i < names.size(); ++i)
+            thread_pool.submit(
+                [&, i]
+                {
+                    const std::string path = pack_path + '/' + names[i];
+                    int width, height;
+                    if (!read_image_size(path, width, height) || width != texture_size || height != texture_size) return;
+
+                    if (decode_image_frame(path, texture_size, 0, pixels.data() + chain_size * i).empty())
+                    {
+                        std::uint8_t* chain = pixels.data() + chain_size * i;
+                        generate_mip_chain(chain, texture_size, is_cutout_texture(chain, texture_size));
+                        is_included[i] = true;
+                    }
+                }
+            );
+        thread_pool.wait();
+    }
+
+    std::vector<IndexEntry> index;
+    std::string name_data;
+    for (std::size_t i = 0; i < names.size(); ++i)
+    {
+        if (!is_included[i]) continue;
+        index.push_back({static_cast<std::uint32_t>(name_data.size()), static_cast<std::uint32_t>(names[i].size()), index.size() * chain_size});
+        name_data += names[i];
+    }
+
+    Header header {};
+    std::memcpy(header.magic, TEXTURE_BUNDLE_MAGIC, sizeof(TEXTURE_BUNDLE_MAGIC));
+    header.version = TEXTURE_BUNDLE_VERSION;
+    header.format = TextureBundleFormat::RGBA8;
+    header.texture_size = texture_size;
+    header.num_levels = get_num_mip_levels(texture_size);
+    header.num_textures = index.size();
+    header.index_offset = sizeof(Header);
+    header.names_offset = header.index_offset + index.size() * sizeof(IndexEntry);
+    header.pixels_offset = (header.names_offset + name_data.size() + BUNDLE_PIXELS_ALIGNMENT - 1) / BUNDLE_PIXELS_ALIGNMENT * BUNDLE_PIXELS_ALIGNMENT;
+
+    std::ofstream file {filepath, std::ios::binary};
+    if (!file)
+    {
+        std::cerr << "Failed to bake texture bundle: file \"" << filepath << "\" could not be created\n";
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(IndexEntry));
+    file.write(name_data.data(), name_data.size());
+    file.write("\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0", header.pixels_offset - header.names_offset - name_data.size());
+    for (std::size_t i = 0; i < names.size(); ++i)
+        if (is_included[i]) file.write(reinterpret_cast<const char*>(pixels.data() + chain_size * i), chain_size);
+
+    if (!file)
+    {
+        std::cerr << "Failed to bake texture bundle: writing to \"" << filepath << "\" failed\n";
+        return false;
+    }
+
+    std::cout << "Baked " << index.size() << " of " << names.size() << " images into \"" << filepath << "\"\n";
+    return true;
+}
+
+const std::uint8_t* TextureBundle::find(const std::string& path) const
+{
+    if (!this->header) return nullptr;
+
+    const std::string name = std::filesystem::path {path}.lexically_normal().lexically_relative(this->directory).generic_string();
+
+    const IndexEntry* end = this->index + this->header->num_textures;
+    const IndexEntry* entry =
+        std::lower_bound(this->index, end, name, [this](const IndexEntry& entry, const std::string& name) { return this->get_name(entry) < name; });
+    if (entry == end || this->get_name(*entry) != name) return nullptr;
+
+    return this->mapping + this->header->pixels_offset + entry->pixels_offset;
+}
+
+bool TextureBundle::is_open() const
+{
+    return this->header;
+}
+
+int TextureBundle::get_texture_size() const
+{
+    return this->header ? this->header->texture_size : 0;
+}
+
+int TextureBundle::get_num_textures() const
+{
+    return this->header ? this->header->num_textures : 0;
+}
+
+bool TextureBundle::is_index_valid(const Header& header) const
+{
+    const IndexEntry* index = reinterpret_cast<const IndexEntry*>(this->mapping + header.index_offset);
+    const std::uint64_t chain_size = get_mip_chain_size(header.texture_size);
+
+    // Names are stored before the pixels. Lookups binary search them, so besides lying within the file they have to be sorted, which also rules out
+    // duplicates
+    std::string_view previous_name;
+    for (std::uint32_t i = 0; i < header.num_textures; ++i)
+    {
+        const IndexEntry& entry = index[i];
+        if (!utils::is_range_within(entry.name_offset, entry.name_length, header.pixels_offset - header.names_offset)
+            || !utils::is_range_within(entry.pixels_offset, chain_size, this->mapping_size - header.pixels_offset))
+            return false;
+
+        const std::string_view name {reinterpret_cast<const char*>(this->mapping + header.names_offset + entry.name_offset), entry.name_length};
+        if (i > 0 && name <= previous_name) return false;
+        previous_name = name;
+    }
+
+    return true;
+}
+
+std::string_view TextureBundle::get_name(const IndexEntry& entry) const
+{
+    return {reinterpret_cast<const char*>(this->mapping + this->header->names_offset + entry.name_offset), entry.name_length};
+}
+
+}  // namespace rb
@@ -0,0 +1,73 @@
+#pragma once
+
+namespace rb
+{
+
+static constexpr char TEXTURE_BUNDLE_MAGIC[4] = {'R', 'B', 'T', 'X'};
+// Increment whenever the layout of bundles or the way their mip chains are generated changes, bundles of other versions are rejected and have to be baked
+// again
+static constexpr std::uint32_t TEXTURE_BUNDLE_VERSION = 3;
+
+enum class TextureBundleFormat : std::uint32_t
+{
+    RGBA8,
+};
+
+// Every block texture of a resource pack with its full mip chain in one file that is mapped into memory, so that textures are uploaded straight from the
+// mapping instead of being decoded on every run
+class TextureBundle
+{
+public:
+    // Leaves the bundle empty if the file does not exist or is not a valid bundle
+    TextureBundle(const std::string& filepath);
+    TextureBundle(const TextureBundle&) = delete;
+    TextureBundle& operator=(const TextureBundle&) = delete;
+    ~TextureBundle();
+
+    // Decodes every image of the resource pack that is a square of the given size, generates its mip chain and writes them all to a bundle file, which
+    // has to be stored in the directory of the resource pack
+    static bool bake(const std::string& pack_path, const std::string& filepath, int texture_size);
+
+    // Returns the mip chain of the image at the path with levels stored one after another largest first, or null if the bundle does not contain the image.
+    // Images changed after baking are not noticed
+    const std::uint8_t* find(const std::string& path) const;
+
+    bool is_open() const;
+    int get_texture_size() const;
+    int get_num_textures() const;
+
+private:
+    struct Header
+    {
+        char magic[4];
+        std::uint32_t version;
+        TextureBundleFormat format;
+        std::uint32_t texture_size;
+        std::uint32_t num_levels;
+        std::uint32_t num_textures;
+        std::uint64_t index_offset;
+        std::uint64_t names_offset;
+        std::uint64_t pixels_offset;
+    };
+
+    // Entries are sorted by name, which is the path of the image relative to the resource pack
+    struct IndexEntry
+    {
+        std::uint32_t name_offset;
+        std::uint32_t name_length;
+        std::uint64_t pixels_offset;
+    };
+
+    // Checks that the name and mip chain of every entry lie within their sections of the file and that the names are sorted
+    bool is_index_valid(const Header& header) const;
+    std::string_view get_name(const IndexEntry& entry) const;
+
+    const std::uint8_t* mapping = nullptr;
+    std::size_t mapping_size = 0;
+    const Header* header = nullptr;
+    const IndexEntry* index = nullptr;
+    // Directory of the resource pack, which names in the index are relative to
+    std::filesystem::path directory;
+};
+
+}  // namespace rb
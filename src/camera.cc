@@ -3,6 +3,29 @@
 namespace rb
 {
 
+Frustum::Frustum(const glm::mat4& view_projection_matrix)
+{
+    // Gribb-Hartmann plane extraction, each plane points into the frustum
+    const glm::mat4& m = view_projection_matrix;
+    for (int i = 0; i < 3; ++i)
+    {
+        this->planes[i * 2] = glm::vec4 {m[0][3] + m[0][i], m[1][3] + m[1][i], m[2][3] + m[2][i], m[3][3] + m[3][i]};
+        this->planes[i * 2 + 1] = glm::vec4 {m[0][3] - m[0][i], m[1][3] - m[1][i], m[2][3] - m[2][i], m[3][3] - m[3][i]};
+    }
+}
+
+bool Frustum::intersects_box(const glm::vec3& min, const glm::vec3& max) const
+{
+    for (const auto& plane : this->planes)
+    {
+        // The box is outside if even its corner furthest along the plane normal is behind the plane
+        const glm::vec3 corner {plane.x > 0.0f ? max.x : min.x, plane.y > 0.0f ? max.y : min.y, plane.z > 0.0f ? max.z : min.z};
+        if (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0.0f) return false;
+    }
+
+    return true;
+}
+
 Camera::Config::Config(int viewport_width, int viewport_height) : viewport_width(viewport_width), viewport_height(viewport_height)
 { }
 
@@ -83,7 +106,10 @@ OrthographicCamera::Config::Config(int viewport_width, int viewport_height, floa
   , zoom_level(zoom_level)
 { }
 
-OrthographicCamera::Config::Config(float aspect_ratio, float zoom_level) : aspect_ratio(aspect_ratio), zoom_level(zoom_level)
+OrthographicCamera::Config::Config(float aspect_ratio, float zoom_level, int viewport_height)
+  : Camera::Config(static_cast<int>(aspect_ratio * static_cast<float>(viewport_height) + 0.5f), viewport_height)
+  , aspect_ratio(aspect_ratio)
+  , zoom_level(zoom_level)
 { }
 
 OrthographicCamera::OrthographicCamera(const Config& config)
@@ -99,6 +125,11 @@ void OrthographicCamera::zoom_in(float zoom_level)
     this->dirty_view_projection_matrix = true;
 }
 
+float OrthographicCamera::get_projected_size(float size, const glm::vec3& position) const
+{
+    return size * this->config.viewport_height / (2.0f * this->config.zoom_level);
+}
+
 IsometricCamera::IsometricCamera(const Config& config) : OrthographicCamera(config)
 {
     this->increment_pitch(-31.5f);
@@ -118,6 +149,12 @@ void PerspectiveCamera::zoom_in(float zoom_level)
     this->dirty_view_projection_matrix = true;
 }
 
+float PerspectiveCamera::get_projected_size(float size, const glm::vec3& position) const
+{
+    const float distance = glm::max(glm::length(position - this->position), 0.1f);
+    return size * this->config.viewport_height / (2.0f * glm::tan(glm::radians(this->config.fov) * 0.5f) * distance);
+}
+
 CameraController::CameraController(const Config& config, Camera* camera) : config(config), camera(camera)
 { }
 
@@ -5,6 +5,17 @@
 namespace rb
 {
 
+class Frustum
+{
+public:
+    Frustum(const glm::mat4& view_projection_matrix);
+
+    bool intersects_box(const glm::vec3& min, const glm::vec3& max) const;
+
+private:
+    std::array<glm::vec4, 6> planes;
+};
+
 class Camera
 {
 public:
@@ -28,10 +39,14 @@ public:
 
     virtual void zoom_in(float zoom_level) = 0;
 
+    // Size in pixels of an object of the given size at the given position
+    virtual float get_projected_size(float size, const glm::vec3& position) const = 0;
+
     const glm::mat4& get_view_projection_matrix();
 
 protected:
     glm::mat4 projection_matrix;
+    glm::vec3 position {0.0f};
 
     bool dirty_view_projection_matrix = true;
 
@@ -43,7 +58,6 @@ private:
 
     float pitch = 0.0f;
     float yaw = -90.0f;
-    glm::vec3 position {0.0f};
     glm::vec3 look_at;
     glm::mat4 view_matrix;
     glm::mat4 view_projection_matrix;
@@ -59,7 +73,8 @@ public:
     {
         Config() = default;
         Config(int viewport_width, int viewport_height, float zoom_level);
-        Config(float aspect_ratio, float zoom_level);
+        // Level of detail selection needs the height of the viewport in pixels, so it is required even when the aspect ratio is given directly
+        Config(float aspect_ratio, float zoom_level, int viewport_height);
 
         float aspect_ratio;
         float zoom_level;
@@ -68,6 +83,7 @@ public:
     OrthographicCamera(const Config& config);
 
     virtual void zoom_in(float delta_zoom) override;
+    virtual float get_projected_size(float size, const glm::vec3& position) const override;
 
 private:
     Config config;
@@ -90,6 +106,7 @@ public:
     PerspectiveCamera(const Config& config);
 
     virtual void zoom_in(float delta_zoom) override;
+    virtual float get_projected_size(float size, const glm::vec3& position) const override;
 
 private:
     Config config;
@@ -3,22 +3,25 @@
 namespace rb
 {
 
-using Index = std::uint16_t;
+using Index = std::uint32_t;
 
 }
 
-static constexpr int MAX_TEXTURE_SLOTS = 32;
+// Width and height of every block texture face
+static constexpr int BLOCK_TEXTURE_SIZE = 16;
+// Bytes of texture memory block textures may take up, least recently used textures are evicted beyond it
+static constexpr int TEXTURE_MEMORY_BUDGET = 64 << 20;
 
 static constexpr int WIDTH = 1920;
 static constexpr int HEIGHT = 1080;
 static constexpr float ASPECT_RATIO = static_cast<float>(WIDTH) / HEIGHT;
 
-static constexpr int NUM_BLOCKS = 2;
-static constexpr int NUM_VERTICES = NUM_BLOCKS * 8;
-static constexpr int NUM_INDICES = NUM_BLOCKS * 36;
+static constexpr int CHUNK_SIZE = 16;
+static constexpr int NUM_LOD_LEVELS = 4;
 
-static constexpr std::array<rb::Index, 36> BLOCK_INDICES = {0, 3, 1, 3, 2, 1, 1, 2, 5, 2, 6, 5, 5, 6, 4, 6, 7, 4,
-                                                            4, 7, 0, 7, 3, 0, 3, 7, 2, 7, 6, 2, 4, 0, 5, 0, 1, 5};
+static constexpr int BENCHMARK_FRAMES = 60;
+// Translucent block the offscreen build hovers over the structure to check that the depth pre-pass leaves blended faces alone
+static constexpr char TRANSLUCENT_TEST_BLOCK[] = "minecraft:stained_glass";
 
 static constexpr char STARTUP_MESSAGE[] = R"(
   _____                _             ____        _   
@@ -1,11 +1,55 @@
-#define STB_IMAGE_IMPLEMENTATION
 #include "cubemap.h"
 
-#include "stb/stb_image.h"
+#include "buffer.h"
+#include "state_cache.h"
 
 namespace rb
 {
 
+// Have to match the flags in the shaders
+static constexpr int FACE_ANIMATED_BIT = 1 << 24;
+static constexpr int FACE_CUTOUT_BIT = 1 << 25;
+
+namespace utils
+{
+
+static BufferObject create_table_buffer(GLenum target, GLsizeiptr size, const void* data)
+{
+    BufferObject buffer = create_buffer();
+    buffer.set_size(size);
+
+    if (GLAD_GL_VERSION_4_5)
+    {
+        glNamedBufferStorage(buffer.get_id(), size, data, GL_DYNAMIC_STORAGE_BIT);
+    }
+    else
+    {
+        glBindBuffer(target, buffer.get_id());
+        glBufferData(target, size, data, GL_DYNAMIC_DRAW);
+    }
+
+    return buffer;
+}
+
+// Lets shaders fetch the integers of the buffer through a sampler, which unlike a storage buffer every stage of a GL 3.3 context can read
+static TextureObject create_buffer_texture(GLuint buffer, int texture_unit)
+{
+    GLuint id;
+    if (GLAD_GL_VERSION_4_5)
+    {
+        glCreateTextures(GL_TEXTURE_BUFFER, 1, &id);
+        glTextureBuffer(id, GL_R32I, buffer);
+        return TextureObject {id};
+    }
+
+    glGenTextures(1, &id);
+    StateCache::get_current()->bind_texture(texture_unit, GL_TEXTURE_BUFFER, id);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32I, buffer);
+    return TextureObject {id};
+}
+
+}  // namespace utils
+
 CubemapFaceTexturePaths::CubemapFaceTexturePaths(
     const std::string& east, const std::string& west, const std::string& up, const std::string& down, const std::string& south, const std::string& north
 )
@@ -16,64 +60,118 @@ CubemapFaceTexturePaths::CubemapFaceTexturePaths(const std::string& all_faces)
   : east(all_faces), west(all_faces), up(all_faces), down(all_faces), south(all_faces), north(all_faces)
 { }
 
-Cubemap::Cubemap(const CubemapFaceTexturePaths& texture_paths)
+CubemapTable::CubemapTable(TextureCache& texture_cache) : texture_cache(texture_cache)
+{ }
+
+int CubemapTable::add_cubemap(const CubemapFaceTexturePaths& texture_paths)
 {
-    glGenTextures(1, &this->id);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, this->id);
-
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-    // TODO: prevent repeatedly loading the same textures
-
-    this->load_face_texture(texture_paths.east, 0);
-    this->load_face_texture(texture_paths.west, 1);
-    this->load_face_texture(texture_paths.up, 2);
-    this->load_face_texture(texture_paths.down, 3);
-    this->load_face_texture(texture_paths.south, 4);
-    this->load_face_texture(texture_paths.north, 5);
+    const int cubemap = this->get_num_cubemaps();
+
+    const std::array<const std::string*, 6> paths = {
+        &texture_paths.east, &texture_paths.west, &texture_paths.up, &texture_paths.down, &texture_paths.south, &texture_paths.north
+    };
+    for (int face = 0; face < 6; ++face)
+    {
+        const TextureAnimation& animation = texture_paths.animations[face];
+        const bool is_alpha_mask = texture_paths.tints[face] == TextureTint::GRASS_OVERLAY;
+        this->face_textures.push_back(this->texture_cache.load(*paths[face], animation.frames.empty() ? 0 : animation.frames[0], is_alpha_mask));
+        this->face_animations.push_back(animation.frames.size() > 1 ? this->add_animation(*paths[face], animation, is_alpha_mask) : -1);
+    }
+    this->face_tints.insert(this->face_tints.end(), texture_paths.tints.begin(), texture_paths.tints.end());
+
+    this->is_dirty = true;
+    return cubemap;
 }
 
-void Cubemap::load_face_texture(const std::string& texture_path, int index) const
+void CubemapTable::bind(int texture_unit)
 {
-    int width, height, num_channels;
-    stbi_uc* data = stbi_load(texture_path.c_str(), &width, &height, &num_channels, 0);
+    for (int texture : this->face_textures)
+        this->texture_cache.request(texture);
+    for (int texture : this->frame_textures)
+        this->texture_cache.request(texture);
+    this->texture_cache.finish_loading();
 
-    if (data == nullptr)
+    if (this->is_dirty || this->generation != this->texture_cache.get_generation())
     {
-        std::cerr << "Failed to load cubemap face texture: file \"" << texture_path << "\" was not found\n";
-        stbi_image_free(data);
-        return;
+        const int num_faces = static_cast<int>(this->face_textures.size());
+        std::vector<int> face_layers(num_faces + this->frame_textures.size());
+        for (int i = 0; i < num_faces; ++i)
+        {
+            // Frames of an animation share the alpha of their strip, so the first frame tells whether an animated face is a cutout as well
+            const int animation = this->face_animations[i];
+            const int entry = animation >= 0 ? animation | FACE_ANIMATED_BIT : this->texture_cache.get_layer(this->face_textures[i]);
+            const int cutout_flag = this->texture_cache.is_cutout(this->face_textures[i]) ? FACE_CUTOUT_BIT : 0;
+            face_layers[i] = entry | cutout_flag | static_cast<int>(this->face_tints[i]) << 16;
+        }
+        for (int i = 0; i < this->frame_textures.size(); ++i)
+            face_layers[num_faces + i] = this->texture_cache.get_layer(this->frame_textures[i]);
+
+        const auto is_translucent = [this](int texture) { return this->texture_cache.is_translucent(texture); };
+        this->is_any_face_translucent = std::any_of(this->face_textures.begin(), this->face_textures.end(), is_translucent)
+                                        || std::any_of(this->frame_textures.begin(), this->frame_textures.end(), is_translucent);
+
+        // Adding cubemaps changes the size of the table, so the buffer is sized to fit it exactly and replaced then
+        const GLsizeiptr size = static_cast<GLsizeiptr>(face_layers.size() * sizeof(int));
+        if (this->is_dirty)
+        {
+            this->buffer = utils::create_table_buffer(GL_TEXTURE_BUFFER, size, face_layers.data());
+            this->buffer_texture = utils::create_buffer_texture(this->buffer.get_id(), texture_unit);
+
+            // Frames are listed after the faces, whose number has changed. The block is always bound whole, as shaders declare it at its maximum size
+            std::vector<glm::ivec4> animations(MAX_TEXTURE_ANIMATIONS);
+            for (int i = 0; i < this->animations.size(); ++i)
+                animations[i] = {num_faces + this->animations[i].first_frame, this->animations[i].num_frames, this->animations[i].ticks_per_frame, 0};
+            this->animation_buffer =
+                utils::create_table_buffer(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(animations.size() * sizeof(glm::ivec4)), animations.data());
+        }
+        else
+        {
+            write_buffer(this->buffer.get_id(), 0, size, face_layers.data());
+        }
+
+        this->generation = this->texture_cache.get_generation();
+        this->is_dirty = false;
     }
 
-    GLenum internal_format, data_format = 0;
+    StateCache::get_current()->bind_texture(texture_unit, GL_TEXTURE_BUFFER, this->buffer_texture.get_id());
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, this->animation_buffer.get_id());
+}
+
+int CubemapTable::get_num_cubemaps() const
+{
+    return static_cast<int>(this->face_textures.size() / 6);
+}
+
+bool CubemapTable::has_translucent_faces() const
+{
+    return this->is_any_face_translucent;
+}
+
+int CubemapTable::add_animation(const std::string& path, const TextureAnimation& animation, bool is_alpha_mask)
+{
+    const int ticks_per_frame = std::max(animation.ticks_per_frame, 1);
 
-    switch (num_channels)
+    // Faces of one block usually share their animation
+    for (int i = 0; i < this->animations.size(); ++i)
     {
-        case 4:
-            internal_format = GL_RGBA8;
-            data_format = GL_RGBA;
-            break;
-
-        case 3:
-            internal_format = GL_RGB8;
-            data_format = GL_RGB;
-            break;
+        const Animation& other = this->animations[i];
+        if (other.path == path && other.frames == animation.frames && other.is_alpha_mask == is_alpha_mask && other.ticks_per_frame == ticks_per_frame)
+            return i;
     }
 
-    if (!internal_format || !data_format)
+    // Checked before loading, so that animations past the limit do not take up layers with frames that are never shown
+    if (this->animations.size() == MAX_TEXTURE_ANIMATIONS)
     {
-        std::cerr << "Failed to load cubemap face texture: number of channels (" << num_channels << ") in image \"" << texture_path << "\" is not supported\n";
-        stbi_image_free(data);
-        return;
+        std::cerr << "Failed to animate texture: \"" << path << "\" exceeds the limit of " << MAX_TEXTURE_ANIMATIONS << " animations\n";
+        return -1;
     }
 
-    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + index, 0, internal_format, width, height, 0, data_format, GL_UNSIGNED_BYTE, data);
+    const int first_frame = static_cast<int>(this->frame_textures.size());
+    for (int frame : animation.frames)
+        this->frame_textures.push_back(this->texture_cache.load(path, frame, is_alpha_mask));
 
-    stbi_image_free(data);
+    this->animations.push_back({path, animation.frames, is_alpha_mask, first_frame, static_cast<int>(animation.frames.size()), ticks_per_frame});
+    return static_cast<int>(this->animations.size()) - 1;
 }
 
 }  // namespace rb
@@ -1,10 +1,25 @@
 #pragma once
 
+#include "biome.h"
 #include "glad/glad.h"
+#include "object.h"
+#include "texture.h"
 
 namespace rb
 {
 
+// Has to match the size of the animation table in the shaders, which keeps it within the smallest uniform block size the GL has to support
+static constexpr int MAX_TEXTURE_ANIMATIONS = 1024;
+
+// Flipbook of a face, whose image is a vertical strip of square frames
+struct TextureAnimation
+{
+    // Frames of the strip in the order they are shown, which may repeat frames. Faces with less than two frames are not animated
+    std::vector<int> frames;
+    // In game ticks of 1/20 seconds
+    int ticks_per_frame = 1;
+};
+
 class CubemapFaceTexturePaths
 {
 public:
@@ -15,17 +30,65 @@ public:
     );
 
     std::string east, west, up, down, south, north;
+    // In the order of the faces above
+    std::array<TextureTint, 6> tints {};
+    std::array<TextureAnimation, 6> animations {};
 };
 
-class Cubemap
+// Every block texture as the six texture array layers of its cubemap faces, so that faces sharing an image share a layer as well, and a fragment
+// selects its texture with one indexed fetch instead of a branch
+class CubemapTable
 {
 public:
-    Cubemap(const CubemapFaceTexturePaths& texture_paths);
+    CubemapTable(TextureCache& texture_cache);
+
+    // Loads the faces through the cache and returns the index of the new cubemap
+    int add_cubemap(const CubemapFaceTexturePaths& texture_paths);
+
+    // Requests the textures of every cubemap from the cache for the current frame and binds the table of every cubemap face, indexed by cubemap * 6 + face,
+    // as an integer buffer texture to the texture unit. Entries hold the layer in their low 16 bits, the tint above and flag faces whose textures are cut
+    // out at the alpha cutoff rather than blended. As meshes only refer to cubemaps, textures can move between layers without remeshing.
+    //
+    // Entries of animated faces are flagged and hold the index of their animation instead of a layer. Animations are bound to uniform buffer binding 0 as
+    // the index of their first frame's layer in the face table, which lists the layers of every frame after the faces, their number of frames and their
+    // ticks per frame, so that shaders pick the frame from the time alone
+    void bind(int texture_unit);
+
+    int get_num_cubemaps() const;
+    // Whether any face has texels to blend as of the last call to bind, without which the translucent pass can be skipped
+    bool has_translucent_faces() const;
 
 private:
-    GLuint id;
+    struct Animation
+    {
+        // Identify the animation, as the same file, frames and alpha handling always load the same textures
+        std::string path;
+        std::vector<int> frames;
+        bool is_alpha_mask;
+        // Index into the frame textures
+        int first_frame;
+        int num_frames;
+        int ticks_per_frame;
+    };
+
+    // Returns the index of an identical animation, or else loads every frame of a new one and returns its index, or -1 if the table of animations is full
+    int add_animation(const std::string& path, const TextureAnimation& animation, bool is_alpha_mask);
+
+    TextureCache& texture_cache;
+    std::vector<int> face_textures;
+    std::vector<TextureTint> face_tints;
+    // Index into the animations, or -1 for faces that are not animated
+    std::vector<int> face_animations;
+    std::vector<Animation> animations;
+    std::vector<int> frame_textures;
 
-    void load_face_texture(const std::string& texture_path, int index) const;
+    BufferObject buffer;
+    TextureObject buffer_texture;
+    BufferObject animation_buffer;
+    // Generation of the cache the layers in the buffer were resolved at
+    int generation = -1;
+    bool is_dirty = false;
+    bool is_any_face_translucent = false;
 };
 
 }  // namespace rb
@@ -0,0 +1,173 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include "image.h"
+
+#include "stb/stb_image.h"
+
+#include <png.h>
+
+namespace rb
+{
+
+static constexpr int PNG_SIGNATURE_SIZE = 8;
+
+namespace utils
+{
+
+static bool has_frame(int width, int height, int size, int frame)
+{
+    return width == size && height % size == 0 && frame < height / size;
+}
+
+static void on_png_error(png_structp png, png_const_charp message)
+{
+    png_longjmp(png, 1);
+}
+
+// Resource packs are full of harmless warnings such as incorrect colour profiles
+static void on_png_warning(png_structp png, png_const_charp message)
+{ }
+
+// libpng reports errors by jumping back to the setjmp, skipping destructors, so only trivially destructible state may live here. Frames are sorted and
+// distinct, rows of frames that are not wanted are decoded but not stored
+static bool read_png_frames(std::FILE* file, int size, const ImageFrame* frames, int num_frames, int& width, int& height)
+{
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, on_png_error, on_png_warning);
+    if (!png) return false;
+    png_infop info = png_create_info_struct(png);
+    if (!info || setjmp(png_jmpbuf(png)))
+    {
+        png_destroy_read_struct(&png, &info, nullptr);
+        return false;
+    }
+
+    png_init_io(png, file);
+    png_set_sig_bytes(png, PNG_SIGNATURE_SIZE);
+    png_read_info(png, info);
+
+    width = static_cast<int>(png_get_image_width(png, info));
+    height = static_cast<int>(png_get_image_height(png, info));
+    const int last_frame = frames[num_frames - 1].frame;
+    if (!has_frame(width, height, size, last_frame))
+    {
+        png_destroy_read_struct(&png, &info, nullptr);
+        return false;
+    }
+
+    // Expanding turns palettes into RGB, grey of less than 8 bits into bytes and transparency chunks into alpha, the alpha filler is only added to
+    // images without alpha
+    png_set_expand(png);
+    png_set_strip_16(png);
+    png_set_gray_to_rgb(png);
+    png_set_add_alpha(png, 0xFF, PNG_FILLER_AFTER);
+    const int num_passes = png_set_interlace_handling(png);
+    png_read_update_info(png, info);
+
+    // Interlaced images revisit every row in every pass, otherwise reading stops at the end of the last wanted frame
+    const int num_rows = num_passes > 1 ? height : (last_frame + 1) * size;
+    for (int pass = 0; pass < num_passes; ++pass)
+    {
+        int next_frame = 0;
+        for (int y = 0; y < num_rows; ++y)
+        {
+            while (next_frame < num_frames && frames[next_frame].frame < y / size)
+                ++next_frame;
+
+            const bool is_in_frame = next_frame < num_frames && frames[next_frame].frame == y / size;
+            png_read_row(png, is_in_frame ? frames[next_frame].pixels + static_cast<std::size_t>(y % size) * size * 4 : nullptr, nullptr);
+        }
+    }
+
+    png_destroy_read_struct(&png, &info, nullptr);
+    return true;
+}
+
+static std::string get_size_error(const std::string& path, int width, int height, int size, int frame)
+{
+    if (width != size || height % size)
+        return "image \"" + path + "\" is " + std::to_string(width) + 'x' + std::to_string(height) + " instead of " + std::to_string(size) + 'x'
+             + std::to_string(size) + " or a strip of frames of that size";
+    return "image \"" + path + "\" has " + std::to_string(height / size) + " frames instead of at least " + std::to_string(frame + 1);
+}
+
+}  // namespace utils
+
+bool read_image_size(const std::string& path, int& width, int& height)
+{
+    int num_channels;
+    return stbi_info(path.c_str(), &width, &height, &num_channels);
+}
+
+std::string decode_image_frame(const std::string& path, int size, int frame, std::uint8_t* pixels)
+{
+    return decode_image_frames(path, size, {{frame, pixels}});
+}
+
+std::string decode_image_frames(const std::string& path, int size, const std::vector<ImageFrame>& frames)
+{
+    if (frames.empty()) return {};
+
+    // Frames are decoded in the order they are stored, every frame into its first destination only, which the others are copied from afterwards
+    std::vector<ImageFrame> decoded_frames = frames;
+    std::sort(decoded_frames.begin(), decoded_frames.end(), [](const ImageFrame& a, const ImageFrame& b) { return a.frame < b.frame; });
+    decoded_frames.erase(
+        std::unique(decoded_frames.begin(), decoded_frames.end(), [](const ImageFrame& a, const ImageFrame& b) { return a.frame == b.frame; }),
+        decoded_frames.end()
+    );
+    if (decoded_frames.front().frame < 0) return "image \"" + path + "\" has no frame " + std::to_string(decoded_frames.front().frame);
+    const int last_frame = decoded_frames.back().frame;
+
+    const std::size_t frame_size = static_cast<std::size_t>(size) * size * 4;
+    const auto copy_repeated_frames = [&]
+    {
+        for (const auto& frame : frames)
+        {
+            const auto decoded = std::lower_bound(
+                decoded_frames.begin(), decoded_frames.end(), frame.frame, [](const ImageFrame& a, int frame) { return a.frame < frame; }
+            );
+            if (decoded->pixels != frame.pixels) std::memcpy(frame.pixels, decoded->pixels, frame_size);
+        }
+    };
+
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return "image \"" + path + "\" could not be opened";
+
+    png_byte signature[PNG_SIGNATURE_SIZE];
+    const bool is_png = std::fread(signature, 1, PNG_SIGNATURE_SIZE, file) == PNG_SIGNATURE_SIZE && !png_sig_cmp(signature, 0, PNG_SIGNATURE_SIZE);
+
+    // Rows are decoded straight into the pixels, so the only allocations besides the list of frames are the ones of libpng itself
+    if (is_png)
+    {
+        int width = 0, height = 0;
+        const bool is_decoded = utils::read_png_frames(file, size, decoded_frames.data(), decoded_frames.size(), width, height);
+        std::fclose(file);
+
+        if (is_decoded)
+        {
+            copy_repeated_frames();
+            return {};
+        }
+        // Errors after the header leave a size that is fine
+        if (width == 0 || utils::has_frame(width, height, size, last_frame)) return "image \"" + path + "\" could not be decoded";
+        return utils::get_size_error(path, width, height, size, last_frame);
+    }
+
+    // Other formats such as TGA go through stb_image, which converts to RGBA while decoding as well but needs an intermediate copy of the whole image
+    std::rewind(file);
+    int width, height, num_channels;
+    stbi_uc* data = stbi_load_from_file(file, &width, &height, &num_channels, 4);
+    std::fclose(file);
+
+    std::string error;
+    if (data == nullptr)
+        error = "image \"" + path + "\" could not be decoded";
+    else if (!utils::has_frame(width, height, size, last_frame))
+        error = utils::get_size_error(path, width, height, size, last_frame);
+    else
+        for (const auto& frame : frames)
+            std::memcpy(frame.pixels, data + frame_size * frame.frame, frame_size);
+
+    stbi_image_free(data);
+    return error;
+}
+
+}  // namespace rb
@@ -0,0 +1,24 @@
+#pragma once
+
+namespace rb
+{
+
+// Reads the size of an image from its header without decoding it, returning false if the file is not an image
+bool read_image_size(const std::string& path, int& width, int& height);
+
+// Destination of one frame of a strip
+struct ImageFrame
+{
+    int frame;
+    std::uint8_t* pixels;
+};
+
+// Decodes a square frame of the given size straight into RGBA pixels. The image is either that square or a vertical strip of frames counted from the top.
+// Grey, grey-alpha, palette and 16-bit images are converted to RGBA in the same pass. Returns why decoding failed, in which case the pixels may have been
+// partly written, or an empty string
+std::string decode_image_frame(const std::string& path, int size, int frame, std::uint8_t* pixels);
+// Decodes any number of frames of the same strip in a single pass over the image, in any order and with frames possibly listed more than once. Fails as a
+// whole if the strip lacks any of the frames
+std::string decode_image_frames(const std::string& path, int size, const std::vector<ImageFrame>& frames);
+
+}  // namespace rb
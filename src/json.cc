@@ -0,0 +1,317 @@
+#include "json.h"
+
+namespace rb
+{
+
+// Objects and arrays are parsed recursively, so nesting is bounded to keep malformed files from overflowing the stack
+static constexpr int MAX_JSON_DEPTH = 64;
+
+namespace utils
+{
+
+class JsonParser
+{
+public:
+    JsonParser(const std::string& text) : text(text)
+    { }
+
+    bool parse(JsonValue& value)
+    {
+        if (!this->parse_value(value)) return false;
+
+        this->skip_whitespace();
+        if (this->position != this->text.size()) return this->fail("unexpected characters after the document");
+        return true;
+    }
+
+    const std::string& get_error() const
+    {
+        return this->error;
+    }
+
+    int get_line() const
+    {
+        return std::count(this->text.begin(), this->text.begin() + this->position, '\n') + 1;
+    }
+
+private:
+    bool parse_value(JsonValue& value)
+    {
+        this->skip_whitespace();
+        if (this->position == this->text.size()) return this->fail("unexpected end of the document");
+
+        switch (this->text[this->position])
+        {
+            case '{':
+            case '[':
+            {
+                if (this->depth == MAX_JSON_DEPTH) return this->fail("objects and arrays are nested too deeply");
+
+                ++this->depth;
+                const bool is_parsed = this->text[this->position] == '{' ? this->parse_object(value) : this->parse_array(value);
+                --this->depth;
+                return is_parsed;
+            }
+
+            case '"':
+                value.type = JsonType::STRING;
+                return this->parse_string(value.string);
+
+            case 't':
+                value.type = JsonType::BOOLEAN;
+                value.boolean = true;
+                return this->expect_keyword("true");
+
+            case 'f':
+                value.type = JsonType::BOOLEAN;
+                return this->expect_keyword("false");
+
+            case 'n':
+                return this->expect_keyword("null");
+        }
+
+        return this->parse_number(value);
+    }
+
+    bool parse_object(JsonValue& value)
+    {
+        value.type = JsonType::OBJECT;
+        ++this->position;
+
+        while (true)
+        {
+            this->skip_whitespace();
+            if (this->consume('}')) return true;
+
+            std::string key;
+            if (this->position == this->text.size() || this->text[this->position] != '"') return this->fail("expected a member name");
+            if (!this->parse_string(key)) return false;
+
+            this->skip_whitespace();
+            if (!this->consume(':')) return this->fail("expected ':' after a member name");
+
+            JsonValue member;
+            if (!this->parse_value(member)) return false;
+            value.object.emplace_back(std::move(key), std::move(member));
+
+            this->skip_whitespace();
+            if (this->consume(',')) continue;
+            if (this->consume('}')) return true;
+            return this->fail("expected ',' or '}' after a member");
+        }
+    }
+
+    bool parse_array(JsonValue& value)
+    {
+        value.type = JsonType::ARRAY;
+        ++this->position;
+
+        while (true)
+        {
+            this->skip_whitespace();
+            if (this->consume(']')) return true;
+
+            JsonValue element;
+            if (!this->parse_value(element)) return false;
+            value.array.push_back(std::move(element));
+
+            this->skip_whitespace();
+            if (this->consume(',')) continue;
+            if (this->consume(']')) return true;
+            return this->fail("expected ',' or ']' after an element");
+        }
+    }
+
+    bool parse_string(std::string& string)
+    {
+        ++this->position;
+
+        while (this->position < this->text.size())
+        {
+            const char c = this->text[this->position++];
+            if (c == '"') return true;
+
+            if (c != '\\')
+            {
+                string += c;
+                continue;
+            }
+
+            if (this->position == this->text.size()) break;
+
+            switch (this->text[this->position++])
+            {
+                case 'b':
+                    string += '\b';
+                    break;
+
+                case 'f':
+                    string += '\f';
+                    break;
+
+                case 'n':
+                    string += '\n';
+                    break;
+
+                case 'r':
+                    string += '\r';
+                    break;
+
+                case 't':
+                    string += '\t';
+                    break;
+
+                case 'u':
+                    if (!this->parse_code_point(string)) return false;
+                    break;
+
+                default:
+                    string += this->text[this->position - 1];
+                    break;
+            }
+        }
+
+        return this->fail("unterminated string");
+    }
+
+    // Surrogate pairs are not combined, names in resource packs are plain ASCII
+    bool parse_code_point(std::string& string)
+    {
+        if (this->position + 4 > this->text.size()) return this->fail("truncated unicode escape");
+
+        unsigned long code_point = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            const char c = this->text[this->position++];
+
+            int digit;
+            if (c >= '0' && c <= '9')
+                digit = c - '0';
+            else if (c >= 'a' && c <= 'f')
+                digit = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                digit = c - 'A' + 10;
+            else
+                return this->fail("invalid unicode escape");
+
+            code_point = code_point << 4 | digit;
+        }
+
+        if (code_point < 0x80)
+        {
+            string += static_cast<char>(code_point);
+        }
+        else if (code_point < 0x800)
+        {
+            string += static_cast<char>(0xC0 | (code_point >> 6));
+            string += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+        else
+        {
+            string += static_cast<char>(0xE0 | (code_point >> 12));
+            string += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            string += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+
+        return true;
+    }
+
+    bool parse_number(JsonValue& value)
+    {
+        const char* begin = this->text.c_str() + this->position;
+        char* end;
+        value.type = JsonType::NUMBER;
+        value.number = std::strtod(begin, &end);
+
+        if (end == begin) return this->fail("unexpected character");
+        this->position += end - begin;
+        return true;
+    }
+
+    bool expect_keyword(const char* keyword)
+    {
+        const int length = std::strlen(keyword);
+        if (this->text.compare(this->position, length, keyword)) return this->fail("unexpected character");
+        this->position += length;
+        return true;
+    }
+
+    void skip_whitespace()
+    {
+        while (this->position < this->text.size())
+        {
+            const char c = this->text[this->position];
+
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+            {
+                ++this->position;
+            }
+            else if (!this->text.compare(this->position, 2, "//"))
+            {
+                const std::size_t line_end = this->text.find('\n', this->position);
+                this->position = line_end == std::string::npos ? this->text.size() : line_end;
+            }
+            else if (!this->text.compare(this->position, 2, "/*"))
+            {
+                const std::size_t comment_end = this->text.find("*/", this->position + 2);
+                this->position = comment_end == std::string::npos ? this->text.size() : comment_end + 2;
+            }
+            else
+            {
+                return;
+            }
+        }
+    }
+
+    bool consume(char c)
+    {
+        if (this->position == this->text.size() || this->text[this->position] != c) return false;
+        ++this->position;
+        return true;
+    }
+
+    bool fail(const char* message)
+    {
+        if (this->error.empty()) this->error = message;
+        return false;
+    }
+
+    const std::string& text;
+    std::size_t position = 0;
+    int depth = 0;
+    std::string error;
+};
+
+}  // namespace utils
+
+const JsonValue* JsonValue::find(const std::string& key) const
+{
+    for (const auto& [member_key, member] : this->object)
+        if (member_key == key) return &member;
+    return nullptr;
+}
+
+JsonValue read_json_file(const std::string& filepath)
+{
+    std::ifstream file {filepath, std::ios::binary};
+    if (!file)
+    {
+        std::cerr << "Failed to read JSON: file \"" << filepath << "\" was not found\n";
+        return {};
+    }
+
+    std::string text {std::istreambuf_iterator<char> {file}, std::istreambuf_iterator<char> {}};
+    if (text.starts_with("\xEF\xBB\xBF")) text.erase(0, 3);
+
+    utils::JsonParser parser {text};
+    JsonValue value;
+    if (!parser.parse(value))
+    {
+        std::cerr << "Failed to read JSON: " << parser.get_error() << " on line " << parser.get_line() << " of \"" << filepath << "\"\n";
+        return {};
+    }
+
+    return value;
+}
+
+}  // namespace rb
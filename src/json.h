@@ -0,0 +1,34 @@
+#pragma once
+
+namespace rb
+{
+
+enum class JsonType
+{
+    NONE,
+    BOOLEAN,
+    NUMBER,
+    STRING,
+    ARRAY,
+    OBJECT,
+};
+
+// Parsed JSON document, members of objects keep the order they are written in
+struct JsonValue
+{
+    // Returns the member with the given key, or null if there is none or the value is not an object
+    const JsonValue* find(const std::string& key) const;
+
+    JsonType type = JsonType::NONE;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+};
+
+// Parses a JSON file, also accepting the comments and trailing commas that resource pack files are often written with. Returns a value of type NONE if the
+// file can not be read or parsed
+JsonValue read_json_file(const std::string& filepath);
+
+}  // namespace rb
@@ -10,34 +10,22 @@
 #    define RB_OFFSCREEN 1
 #endif
 
+#include "biome.h"
 #include "buffer.h"
 #include "camera.h"
 #include "constants.h"
 #include "cubemap.h"
 #include "offscreen.h"
+#include "pack.h"
+#include "pool.h"
+#include "queue.h"
+#include "renderer.h"
 #include "shader.h"
-#include "vertex.h"
+#include "state_cache.h"
+#include "texture.h"
 #include "window.h"
 #include "world.h"
 
-static std::array<rb::Vertex, NUM_VERTICES> vertices;
-static std::array<rb::Index, NUM_INDICES> indices;
-
-static void set_block_vertices(int block_index, int texture_index, const glm::vec3& position)
-{
-    const int index = block_index * 8;
-    const float glsl_texture_index = static_cast<float>(texture_index) + 0.5f;
-
-    vertices[index] = rb::Vertex {position + glm::vec3 {0.0f, 0.0f, 0.0f}, {-0.5f, -0.5f, -0.5f}, glsl_texture_index};
-    vertices[index + 1] = rb::Vertex {position + glm::vec3 {1.0f, 0.0f, 0.0f}, {0.5f, -0.5f, -0.5f}, glsl_texture_index};
-    vertices[index + 2] = rb::Vertex {position + glm::vec3 {1.0f, 1.0f, 0.0f}, {0.5f, 0.5f, -0.5f}, glsl_texture_index};
-    vertices[index + 3] = rb::Vertex {position + glm::vec3 {0.0f, 1.0f, 0.0f}, {-0.5f, 0.5f, -0.5f}, glsl_texture_index};
-    vertices[index + 4] = rb::Vertex {position + glm::vec3 {0.0f, 0.0f, 1.0f}, {-0.5f, -0.5f, 0.5f}, glsl_texture_index};
-    vertices[index + 5] = rb::Vertex {position + glm::vec3 {1.0f, 0.0f, 1.0f}, {0.5f, -0.5f, 0.5f}, glsl_texture_index};
-    vertices[index + 6] = rb::Vertex {position + glm::vec3 {1.0f, 1.0f, 1.0f}, {0.5f, 0.5f, 0.5f}, glsl_texture_index};
-    vertices[index + 7] = rb::Vertex {position + glm::vec3 {0.0f, 1.0f, 1.0f}, {-0.5f, 0.5f, 0.5f}, glsl_texture_index};
-}
-
 int main(int argc, char* argv[])
 {
     std::cout << "\u001B[36m" << STARTUP_MESSAGE << "\u001B[0m";
@@ -45,12 +33,14 @@ int main(int argc, char* argv[])
     if (argc < 2) return 0;
     std::filesystem::current_path(argv[1]);
 
-    rb::World world {"assets/structures/test_2.mcstructure"};
+    // Baking only decodes images, so it needs neither a world nor a window
+    if (argc > 2 && !std::strcmp(argv[2], "--bake-textures"))
+        return rb::TextureBundle::bake("assets/resource_pack", "assets/resource_pack/textures.rbtex", BLOCK_TEXTURE_SIZE) ? 0 : 1;
 
-    for (int i = 0; i < NUM_INDICES; ++i)
-        indices[i] = BLOCK_INDICES[i % 36] + ((i / 36) * 8);
-    set_block_vertices(0, 0, {0.0f, 0.0f, 0.0f});
-    set_block_vertices(1, 1, {1.0f, 0.0f, 0.0f});
+    // Worth it for scenes with a lot of overdraw on hardware where shading fragments is expensive, the offscreen build benchmarks both
+    const bool use_depth_prepass = argc > 2 && !std::strcmp(argv[2], "--depth-prepass");
+
+    rb::World world {"assets/structures/test_2.mcstructure"};
 
     rb::IsometricCamera camera {{WIDTH, HEIGHT, 2.0f}};
 #if RB_REAL_TIME
@@ -75,65 +65,160 @@ int main(int argc, char* argv[])
     const rb::OffscreenWindow window {{3, 3, 8}};
 #endif
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glEnable(GL_DEPTH_TEST);
+    rb::StateCache state_cache;
+    state_cache.set_capability(GL_BLEND, true);
+    state_cache.set_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state_cache.set_capability(GL_DEPTH_TEST, true);
     glEnable(GL_MULTISAMPLE);
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+    state_cache.set_capability(GL_CULL_FACE, true);
+    state_cache.set_cull_face(GL_BACK);
 
     {
 #if RB_OFFSCREEN
         const rb::Framebuffer framebuffer {WIDTH, HEIGHT};
 #endif
 
-        const rb::VertexBuffer vao {sizeof(vertices), static_cast<const void*>(vertices.data())};
-        const rb::IndexBuffer ibo {sizeof(indices), static_cast<const void*>(indices.data())};
+        rb::ChunkRenderer renderer {{window.create_shared_context()}, world};
+        rb::RenderQueue render_queue {1};
         const rb::Shader shader {"render-bat/shaders/cubemap.glsl"};
+        const rb::Shader depth_shader {"render-bat/shaders/depth.glsl"};
+        const rb::Shader translucent_shader {"render-bat/shaders/translucent.glsl"};
+
+        rb::TextureArray block_textures {BLOCK_TEXTURE_SIZE, 4, TEXTURE_MEMORY_BUDGET};
+        rb::ThreadPool thread_pool;
+        const rb::TextureBundle texture_bundle {"assets/resource_pack/textures.rbtex"};
+        rb::TextureCache texture_cache {block_textures, thread_pool, &texture_bundle};
+
+        // Only the textures of materials the structure uses are loaded, with cubemaps added in the order of the materials as texture indices of blocks
+        // index them
+        const rb::ResourcePack resource_pack {"assets/resource_pack"};
+        rb::CubemapTable block_cubemaps {texture_cache};
+        for (const std::string& material : world.get_materials())
+        {
+            const auto texture_paths = resource_pack.get_block_textures(material);
+            if (!texture_paths) std::cerr << "Failed to resolve textures: block \"" << material << "\" is not defined by the resource pack\n";
+            block_cubemaps.add_cubemap(texture_paths.value_or(rb::CubemapFaceTexturePaths {}));
+        }
+        texture_cache.finish_loading();
+        const rb::BiomeColorMap biome_colors;
 
-        const rb::Cubemap grass_cubemap {{
-            "assets/blocks/grass_side_carried.png",
-            "assets/blocks/grass_side_carried.png",
-            "assets/blocks/grass_carried.png",
-            "assets/blocks/dirt.png",
-            "assets/blocks/grass_side_carried.png",
-            "assets/blocks/grass_side_carried.png",
-        }};
-        const rb::Cubemap bedrock_cubemap {{"assets/blocks/bedrock.png"}};
+        // Sampler uniforms are part of the program state, so they only have to be set once
+        for (const rb::Shader* program : {&shader, &depth_shader, &translucent_shader})
+        {
+            state_cache.use_program(program->get_id());
+            program->set_uniform_int("block_textures", 0);
+            program->set_uniform_int("biome_colors", 1);
+            program->set_uniform_int("face_layers", 2);
+            program->set_uniform_block_binding("TextureAnimations", 0);
+        }
 
-#if RB_REAL_TIME
-        while (window.is_open())
+        // Animated textures only depend on it, exports rendering a sequence of frames set it from the frame number rather than the clock
+        float animation_time = 0.0f;
+
+        const auto record_pass = [&](const rb::Shader& program, rb::RenderPass pass)
         {
-            window.update();
-            const auto& state = window.get_state();
-            controller.update(state.dt, state.keyboard);
-#endif
+            state_cache.use_program(program.get_id());
+            program.set_uniform_mat4("MVP", camera.get_view_projection_matrix());
+            program.set_uniform_float("time", animation_time);
+            renderer.record(render_queue, pass, program.get_id());
+        };
+
+        const auto render_frame = [&](bool depth_prepass)
+        {
+            state_cache.begin_frame();
+            texture_cache.begin_frame();
+            render_queue.begin_frame();
+            renderer.begin_frame(camera);
 
             glViewport(0, 0, WIDTH, HEIGHT);
             glClearColor(0.471f, 0.655f, 1.0f, 1.0f);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-            shader.bind();
-            shader.set_uniform_mat4("MVP", camera.get_view_projection_matrix());
-            int cubemaps[MAX_TEXTURE_SLOTS];
-            for (int i = 0; i < MAX_TEXTURE_SLOTS; ++i)
-            {
-                glActiveTexture(GL_TEXTURE0 + i);
-                glBindTexture(GL_TEXTURE_CUBE_MAP, i + 1);
-                cubemaps[i] = i;
-            }
-            shader.set_uniform_int_array("cubemaps", MAX_TEXTURE_SLOTS, cubemaps);
-            vao.bind();
-            glDrawElements(GL_TRIANGLES, NUM_INDICES, GL_UNSIGNED_SHORT, nullptr);
+            // Binding the cubemaps makes their textures resident, which can grow the texture array into a new texture, so it is bound after them
+            block_cubemaps.bind(2);
+            state_cache.bind_texture(0, GL_TEXTURE_2D_ARRAY, block_textures.get_id());
+            state_cache.bind_texture(1, GL_TEXTURE_2D, biome_colors.get_id());
+
+            if (depth_prepass) record_pass(depth_shader, rb::RenderPass::DEPTH_PREPASS);
+            record_pass(shader, rb::RenderPass::OPAQUE);
+            if (block_cubemaps.has_translucent_faces()) record_pass(translucent_shader, rb::RenderPass::TRANSLUCENT);
+
+            render_queue.sort();
+            render_queue.submit(state_cache);
+        };
 
 #if RB_REAL_TIME
+        while (window.is_open())
+        {
+            window.update();
+            const auto& state = window.get_state();
+            controller.update(state.dt, state.keyboard);
+            animation_time += static_cast<float>(state.dt);
+
+            render_frame(use_depth_prepass);
             window.swap_buffers();
         }
 #else
+        renderer.begin_frame(camera);
+        renderer.wait_until_idle();
+        render_frame(use_depth_prepass);
+
         rb::write_color_buffer_to_png_file("../output.png", WIDTH, HEIGHT);
+        std::cout << "Vertex cache ACMR: " << renderer.get_acmr() << '\n';
+        std::cout << "Draw calls: " << render_queue.get_stats().num_draw_calls << " (" << render_queue.get_stats().num_packets << " packets in "
+                  << render_queue.get_stats().num_batches << " batches, " << renderer.get_stats().num_visible_chunks << " visible chunks)\n";
+        std::cout << "Texture cache: " << texture_cache.get_stats().num_hits << " hits, " << texture_cache.get_stats().num_misses << " misses ("
+                  << texture_cache.get_stats().num_bundled << " from the bundle), " << texture_cache.get_stats().num_evictions << " evictions, "
+                  << block_textures.get_num_layers() << " of " << block_textures.get_max_layers() << " layers for " << block_cubemaps.get_num_cubemaps()
+                  << " cubemaps\n";
+        std::cout << "GL state calls: " << state_cache.get_stats().num_issued_calls << " issued, " << state_cache.get_stats().num_skipped_calls << " skipped\n";
+
+        // The pre-pass pays off once the fragments it saves from shading cost more than drawing all geometry a second time. It must never change what a
+        // frame shows, so the frames with and without it are compared pixel by pixel as well
+        const auto compare_depth_prepass = [&](const char* scene)
+        {
+            render_frame(false);
+            const std::vector<std::uint8_t> pixels = rb::read_color_buffer(WIDTH, HEIGHT);
+            render_frame(true);
+            const std::vector<std::uint8_t> prepass_pixels = rb::read_color_buffer(WIDTH, HEIGHT);
+
+            int num_changed_pixels = 0;
+            for (std::size_t i = 0; i < pixels.size(); i += 4)
+                if (std::memcmp(&pixels[i], &prepass_pixels[i], 4)) ++num_changed_pixels;
+
+            std::cout << "Depth pre-pass on " << scene << ": " << num_changed_pixels << " pixels changed, GPU frame time "
+                      << rb::measure_gpu_frame_time(BENCHMARK_FRAMES, [&] { render_frame(false); }) << " ms without and "
+                      << rb::measure_gpu_frame_time(BENCHMARK_FRAMES, [&] { render_frame(true); }) << " ms with it\n";
+        };
+        compare_depth_prepass("the structure");
+
+        // Blended faces are left out of the pre-pass, which a layer of stained glass over the empty top of the structure checks
+        const auto glass_textures = resource_pack.get_block_textures(TRANSLUCENT_TEST_BLOCK);
+        if (!glass_textures)
+        {
+            std::cerr << "Failed to resolve textures: block \"" << TRANSLUCENT_TEST_BLOCK << "\" is not defined by the resource pack\n";
+        }
+        else
+        {
+            const rb::Block glass {rb::BlockShape::CUBE, block_cubemaps.add_cubemap(*glass_textures)};
+            const glm::ivec3& size = world.get_size();
+            for (int x = 0; x < size.x; ++x)
+                for (int z = 0; z < size.z; ++z)
+                {
+                    const glm::ivec3 pos {x, size.y - 1, z};
+                    const bool is_above_air = pos.y == 0 || world.get_block(pos - glm::ivec3 {0, 1, 0}).shape == rb::BlockShape::NONE;
+                    if (world.get_block(pos).shape == rb::BlockShape::NONE && is_above_air) world.set_block(pos, glass);
+                }
+
+            renderer.begin_frame(camera);
+            renderer.wait_until_idle();
+            compare_depth_prepass("stained glass");
+        }
 #endif
     }
 
+    // Everything created above has been destroyed by now, so anything still alive leaked
+    rb::report_live_gl_objects();
+
     return 0;
 }
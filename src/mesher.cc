@@ -0,0 +1,63 @@
+#include "mesher.h"
+
+namespace rb
+{
+
+namespace utils
+{
+
+static bool is_face_culled(const ModelFace& face, const ChunkSnapshot& snapshot, const glm::ivec3& local_pos)
+{
+    if (face.cull_face < 0) return false;
+
+    const Block& neighbour = snapshot.get_block(local_pos + FACE_DIRECTIONS[face.cull_face]);
+    if (neighbour.shape == BlockShape::NONE) return false;
+
+    return model::is_mask_covered(face.mask, get_block_model(neighbour.shape).coverage[model::opposite_face(face.cull_face)]);
+}
+
+static Vertex make_vertex(const glm::ivec3& local_pos, const ModelFace& face, int corner, float texture_index)
+{
+    // Model positions are multiples of 1 / MODEL_RESOLUTION, so scaling them back is exact
+    const glm::ivec3 position = local_pos * MODEL_RESOLUTION + glm::ivec3 {face.positions[corner] * static_cast<float>(MODEL_RESOLUTION)};
+    return {
+        {static_cast<std::uint16_t>(position.x), static_cast<std::uint16_t>(position.y), static_cast<std::uint16_t>(position.z)},
+        static_cast<std::uint16_t>(face.direction),
+        face.uvs[corner],
+        texture_index,
+    };
+}
+
+}  // namespace utils
+
+Mesh mesh_chunk(const ChunkSnapshot& snapshot)
+{
+    Mesh mesh;
+
+    const int size = snapshot.get_size();
+
+    for (int x = 0; x < size; ++x)
+        for (int y = 0; y < size; ++y)
+            for (int z = 0; z < size; ++z)
+            {
+                const glm::ivec3 local_pos {x, y, z};
+                const Block& block = snapshot.get_block(local_pos);
+                if (block.shape == BlockShape::NONE) continue;
+
+                const BlockModel& model = get_block_model(block.shape);
+                const float glsl_texture_index = static_cast<float>(block.texture_index) + 0.5f;
+
+                for (int i = 0; i < model.num_faces; ++i)
+                {
+                    const ModelFace& face = model.faces[i];
+                    if (utils::is_face_culled(face, snapshot, local_pos)) continue;
+
+                    for (int corner = 0; corner < 4; ++corner)
+                        mesh.vertices.push_back(utils::make_vertex(local_pos, face, corner, glsl_texture_index));
+                }
+            }
+
+    return mesh;
+}
+
+}  // namespace rb
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "vertex.h"
+#include "world.h"
+
+namespace rb
+{
+
+struct Mesh
+{
+    // Every four vertices form a quad
+    std::vector<Vertex> vertices;
+};
+
+// Vertex positions are relative to the chunk, the ChunkOrigin of the chunk level places and scales them when drawing
+Mesh mesh_chunk(const ChunkSnapshot& snapshot);
+
+}  // namespace rb
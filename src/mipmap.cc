@@ -0,0 +1,182 @@
+#include "mipmap.h"
+
+#ifdef __SSE2__
+#    include <emmintrin.h>
+#endif
+
+namespace rb
+{
+
+static constexpr int COVERAGE_SEARCH_STEPS = 16;
+
+namespace utils
+{
+
+// Texels of a cutout texture are averaged weighted by their alpha, so that the colour of transparent texels does not bleed into the visible ones
+#ifdef __SSE2__
+static void downsample(const std::uint8_t* source, int source_size, std::uint8_t* level, bool is_cutout)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    const int level_size = source_size / 2;
+
+    // One texel at a time, with its four channels in the lanes of a vector
+    const auto load = [&zero](const std::uint8_t* texel)
+    {
+        std::int32_t bytes;
+        std::memcpy(&bytes, texel, sizeof(bytes));
+        return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero));
+    };
+
+    for (int y = 0; y < level_size; ++y)
+        for (int x = 0; x < level_size; ++x)
+        {
+            const std::uint8_t* texel = source + ((y * 2) * source_size + x * 2) * 4;
+            const __m128 texels[4] = {load(texel), load(texel + 4), load(texel + source_size * 4), load(texel + source_size * 4 + 4)};
+
+            __m128 sum = _mm_add_ps(_mm_add_ps(texels[0], texels[1]), _mm_add_ps(texels[2], texels[3]));
+            __m128 average = _mm_mul_ps(sum, quarter);
+
+            if (is_cutout)
+            {
+                __m128 weighted_sum = _mm_setzero_ps();
+                for (const __m128& t : texels)
+                    weighted_sum = _mm_add_ps(weighted_sum, _mm_mul_ps(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(3, 3, 3, 3))));
+
+                const __m128 alpha_sum = _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 3, 3));
+                if (_mm_cvtss_f32(alpha_sum) > 0.0f)
+                {
+                    // Keeps the plain average in the alpha lane
+                    const __m128 weighted_average = _mm_div_ps(weighted_sum, alpha_sum);
+                    const __m128 alpha_mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+                    average = _mm_or_ps(_mm_and_ps(alpha_mask, average), _mm_andnot_ps(alpha_mask, weighted_average));
+                }
+            }
+
+            const __m128i rounded = _mm_cvtps_epi32(average);
+            const std::int32_t bytes = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(rounded, zero), zero));
+            std::memcpy(level + (y * level_size + x) * 4, &bytes, sizeof(bytes));
+        }
+}
+#else
+static void downsample(const std::uint8_t* source, int source_size, std::uint8_t* level, bool is_cutout)
+{
+    const int level_size = source_size / 2;
+
+    for (int y = 0; y < level_size; ++y)
+        for (int x = 0; x < level_size; ++x)
+        {
+            const std::uint8_t* texel = source + ((y * 2) * source_size + x * 2) * 4;
+            const std::array<const std::uint8_t*, 4> texels = {texel, texel + 4, texel + source_size * 4, texel + source_size * 4 + 4};
+
+            const int alpha_sum = texels[0][3] + texels[1][3] + texels[2][3] + texels[3][3];
+            for (int channel = 0; channel < 4; ++channel)
+            {
+                int sum = 0, weighted_sum = 0;
+                for (const std::uint8_t* t : texels)
+                {
+                    sum += t[channel];
+                    weighted_sum += t[channel] * t[3];
+                }
+
+                const bool is_weighted = is_cutout && channel < 3 && alpha_sum > 0;
+                level[(y * level_size + x) * 4 + channel] = static_cast<std::uint8_t>(is_weighted ? (weighted_sum + alpha_sum / 2) / alpha_sum : (sum + 2) / 4);
+            }
+        }
+}
+#endif
+
+static std::uint8_t scale_alpha(std::uint8_t alpha, float scale)
+{
+    return static_cast<std::uint8_t>(std::min(alpha * scale + 0.5f, 255.0f));
+}
+
+static float get_alpha_coverage(const std::uint8_t* pixels, int size, float alpha_scale)
+{
+    int num_covered = 0;
+    for (int i = 0; i < size * size; ++i)
+        if (scale_alpha(pixels[i * 4 + 3], alpha_scale) >= MIP_ALPHA_CUTOFF) ++num_covered;
+    return static_cast<float>(num_covered) / (size * size);
+}
+
+// Averaging lets alpha drift across the cutoff, so that foliage thins out or grows with distance. Scaling the alpha of the level so that the same share
+// of texels passes the cutoff as in the first level keeps the apparent density (Castano 2010)
+static void preserve_alpha_coverage(std::uint8_t* level, int size, float coverage)
+{
+    float min_scale = 0.0f;
+    float max_scale = 4.0f;
+    for (int step = 0; step < COVERAGE_SEARCH_STEPS; ++step)
+    {
+        const float scale = (min_scale + max_scale) / 2.0f;
+        if (get_alpha_coverage(level, size, scale) < coverage)
+            min_scale = scale;
+        else
+            max_scale = scale;
+    }
+
+    // Small levels only have a few distinct coverages, of which the search ends up between the two closest ones
+    const float min_error = std::abs(get_alpha_coverage(level, size, min_scale) - coverage);
+    const float max_error = std::abs(get_alpha_coverage(level, size, max_scale) - coverage);
+    const float scale = min_error < max_error ? min_scale : max_scale;
+
+    for (int i = 0; i < size * size; ++i)
+        level[i * 4 + 3] = scale_alpha(level[i * 4 + 3], scale);
+}
+
+}  // namespace utils
+
+int get_num_mip_levels(int size)
+{
+    int num_levels = 1;
+    while (size > 1)
+    {
+        size /= 2;
+        ++num_levels;
+    }
+    return num_levels;
+}
+
+std::size_t get_mip_chain_size(int size)
+{
+    std::size_t chain_size = 0;
+    for (int level_size = size; level_size > 0; level_size /= 2)
+        chain_size += static_cast<std::size_t>(level_size) * level_size * 4;
+    return chain_size;
+}
+
+bool is_cutout_texture(const std::uint8_t* pixels, int size)
+{
+    bool has_transparent_texels = false;
+    for (int i = 0; i < size * size; ++i)
+    {
+        const std::uint8_t alpha = pixels[i * 4 + 3];
+        if (alpha != 0 && alpha != 255) return false;
+        if (alpha == 0) has_transparent_texels = true;
+    }
+    return has_transparent_texels;
+}
+
+bool is_translucent_texture(const std::uint8_t* pixels, int size)
+{
+    for (int i = 0; i < size * size; ++i)
+        if (const std::uint8_t alpha = pixels[i * 4 + 3]; alpha != 0 && alpha != 255) return true;
+    return false;
+}
+
+void generate_mip_chain(std::uint8_t* pixels, int size, bool is_cutout)
+{
+    const float coverage = utils::get_alpha_coverage(pixels, size, 1.0f);
+
+    std::uint8_t* source = pixels;
+    for (int source_size = size; source_size > 1; source_size /= 2)
+    {
+        std::uint8_t* level = source + static_cast<std::size_t>(source_size) * source_size * 4;
+
+        utils::downsample(source, source_size, level, is_cutout);
+        if (is_cutout) utils::preserve_alpha_coverage(level, source_size / 2, coverage);
+
+        source = level;
+    }
+}
+
+}  // namespace rb
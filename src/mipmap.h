@@ -0,0 +1,24 @@
+#pragma once
+
+namespace rb
+{
+
+// Alpha below which texels of cutout textures are discarded, has to match ALPHA_CUTOFF of the shaders
+static constexpr int MIP_ALPHA_CUTOFF = 128;
+
+// Number of levels of a full mip chain of a square texture, down to 1x1
+int get_num_mip_levels(int size);
+// Size in bytes of a full RGBA8 mip chain of a square texture with its levels stored one after another, largest first
+std::size_t get_mip_chain_size(int size);
+
+// Whether the texels of a square RGBA8 image are only ever fully transparent or fully opaque, with at least one transparent one. Translucent textures such
+// as stained glass have other alpha values and are blended rather than cut out
+bool is_cutout_texture(const std::uint8_t* pixels, int size);
+// Whether any texel of a square RGBA8 image is neither fully transparent nor fully opaque, which makes it drawn by the translucent pass
+bool is_translucent_texture(const std::uint8_t* pixels, int size);
+// Fills in every level after the first of an RGBA8 mip chain laid out as described above, averaging 2x2 blocks of the previous level. Levels of cutout
+// textures weight colours by alpha and keep the share of texels passing the alpha cutoff of the first level, the alpha of any other texture is averaged
+// like its colours
+void generate_mip_chain(std::uint8_t* pixels, int size, bool is_cutout);
+
+}  // namespace rb
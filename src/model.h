@@ -0,0 +1,200 @@
+#pragma once
+
+namespace rb
+{
+
+enum class BlockShape
+{
+    NONE,
+    CUBE,
+    SLAB,
+    STAIRS,
+    FENCE,
+    TORCH,
+};
+
+static constexpr int NUM_BLOCK_SHAPES = 6;
+static constexpr int NUM_FACES = 6;
+static constexpr int MODEL_RESOLUTION = 16;
+static constexpr int MAX_MODEL_FACES = 12;
+
+// Faces are ordered like the faces of a cubemap: east (+X), west (-X), up (+Y), down (-Y), south (+Z), north (-Z)
+static constexpr std::array<glm::ivec3, NUM_FACES> FACE_DIRECTIONS = {
+    glm::ivec3 {1, 0, 0},
+    glm::ivec3 {-1, 0, 0},
+    glm::ivec3 {0, 1, 0},
+    glm::ivec3 {0, -1, 0},
+    glm::ivec3 {0, 0, 1},
+    glm::ivec3 {0, 0, -1},
+};
+
+// One bit per model texel of a face lying on the boundary of the block
+using FaceMask = std::array<std::uint16_t, MODEL_RESOLUTION>;
+
+struct ModelBox
+{
+    std::array<int, 3> from;
+    std::array<int, 3> to;
+};
+
+struct ModelFace
+{
+    std::array<glm::vec3, 4> positions;
+    std::array<glm::vec2, 4> uvs;
+
+    // Face of the block texture cubemap the face is textured with, which is the direction it points in
+    int direction;
+    // Face of the block this face lies on, or -1 if it lies inside the block and can never be culled
+    int cull_face;
+    FaceMask mask;
+};
+
+struct BlockModel
+{
+    std::array<ModelFace, MAX_MODEL_FACES> faces;
+    int num_faces;
+
+    // Union of the masks of all faces lying on each face of the block
+    std::array<FaceMask, NUM_FACES> coverage;
+};
+
+namespace model
+{
+
+constexpr int opposite_face(int face)
+{
+    return face ^ 1;
+}
+
+constexpr FaceMask rect_mask(int u0, int u1, int v0, int v1)
+{
+    FaceMask mask {};
+    for (int v = v0; v < v1; ++v)
+        for (int u = u0; u < u1; ++u)
+            mask[v] = static_cast<std::uint16_t>(mask[v] | (1 << u));
+    return mask;
+}
+
+constexpr bool is_mask_covered(const FaceMask& mask, const FaceMask& coverage)
+{
+    for (int v = 0; v < MODEL_RESOLUTION; ++v)
+        if (mask[v] & ~coverage[v]) return false;
+    return true;
+}
+
+// Projects a point on the faces of the unit cube around the origin onto the texture of the given face, following the conventions of cubemaps so that
+// partial faces sample the matching part of the texture
+constexpr std::array<float, 2> project_onto_face(int face, const std::array<float, 3>& point)
+{
+    switch (face)
+    {
+        case 0:
+            return {0.5f - point[2], 0.5f - point[1]};
+
+        case 1:
+            return {0.5f + point[2], 0.5f - point[1]};
+
+        case 2:
+            return {0.5f + point[0], 0.5f + point[2]};
+
+        case 3:
+            return {0.5f + point[0], 0.5f - point[2]};
+
+        case 4:
+            return {0.5f + point[0], 0.5f - point[1]};
+
+        default:
+            return {0.5f - point[0], 0.5f - point[1]};
+    }
+}
+
+constexpr bool is_face_hidden_by_box(const ModelBox& box, int axis, int sign, int plane, const ModelBox& other)
+{
+    const int u = (axis + 1) % 3;
+    const int v = (axis + 2) % 3;
+
+    const bool spans_plane = sign > 0 ? other.from[axis] <= plane && other.to[axis] > plane : other.from[axis] < plane && other.to[axis] >= plane;
+    return spans_plane && other.from[u] <= box.from[u] && other.to[u] >= box.to[u] && other.from[v] <= box.from[v] && other.to[v] >= box.to[v];
+}
+
+template<std::size_t N>
+constexpr BlockModel make_model(const std::array<ModelBox, N>& boxes)
+{
+    BlockModel model {};
+
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        const ModelBox& box = boxes[i];
+
+        for (int face = 0; face < NUM_FACES; ++face)
+        {
+            const int axis = face / 2;
+            const int sign = face % 2 == 0 ? 1 : -1;
+            const int u = (axis + 1) % 3;
+            const int v = (axis + 2) % 3;
+            const int plane = sign > 0 ? box.to[axis] : box.from[axis];
+
+            bool is_hidden = false;
+            for (std::size_t j = 0; j < N; ++j)
+                if (j != i && is_face_hidden_by_box(box, axis, sign, plane, boxes[j])) is_hidden = true;
+            if (is_hidden) continue;
+
+            // Corners are wound counter-clockwise when looking at the face from outside
+            const std::array<std::array<int, 2>, 4> corners =
+                sign > 0 ? std::array<std::array<int, 2>, 4> {{{box.from[u], box.from[v]}, {box.to[u], box.from[v]}, {box.to[u], box.to[v]}, {box.from[u], box.to[v]}}}
+                         : std::array<std::array<int, 2>, 4> {{{box.from[u], box.from[v]}, {box.from[u], box.to[v]}, {box.to[u], box.to[v]}, {box.to[u], box.from[v]}}};
+
+            ModelFace& model_face = model.faces[model.num_faces++];
+
+            for (int k = 0; k < 4; ++k)
+            {
+                std::array<float, 3> position {};
+                position[axis] = static_cast<float>(plane) / MODEL_RESOLUTION;
+                position[u] = static_cast<float>(corners[k][0]) / MODEL_RESOLUTION;
+                position[v] = static_cast<float>(corners[k][1]) / MODEL_RESOLUTION;
+
+                std::array<float, 3> cube_point {position[0] - 0.5f, position[1] - 0.5f, position[2] - 0.5f};
+                cube_point[axis] = 0.5f * sign;
+                const std::array<float, 2> uv = project_onto_face(face, cube_point);
+
+                model_face.positions[k] = glm::vec3 {position[0], position[1], position[2]};
+                model_face.uvs[k] = glm::vec2 {uv[0], uv[1]};
+            }
+
+            model_face.direction = face;
+
+            model_face.mask = rect_mask(box.from[u], box.to[u], box.from[v], box.to[v]);
+
+            const bool is_on_boundary = sign > 0 ? plane == MODEL_RESOLUTION : plane == 0;
+            model_face.cull_face = is_on_boundary ? face : -1;
+
+            if (is_on_boundary)
+                for (int row = 0; row < MODEL_RESOLUTION; ++row)
+                    model.coverage[face][row] = static_cast<std::uint16_t>(model.coverage[face][row] | model_face.mask[row]);
+        }
+    }
+
+    return model;
+}
+
+}  // namespace model
+
+static constexpr std::array<BlockModel, NUM_BLOCK_SHAPES> BLOCK_MODELS = {
+    BlockModel {},
+    model::make_model<1>({{{{0, 0, 0}, {16, 16, 16}}}}),
+    model::make_model<1>({{{{0, 0, 0}, {16, 8, 16}}}}),
+    model::make_model<2>({{{{0, 0, 0}, {16, 8, 16}}, {{8, 8, 0}, {16, 16, 16}}}}),
+    model::make_model<1>({{{{6, 0, 6}, {10, 16, 10}}}}),
+    model::make_model<1>({{{{7, 0, 7}, {9, 10, 9}}}}),
+};
+
+static_assert(BLOCK_MODELS[static_cast<int>(BlockShape::CUBE)].num_faces == 6);
+static_assert(BLOCK_MODELS[static_cast<int>(BlockShape::STAIRS)].num_faces == 11);
+static_assert(model::is_mask_covered(model::rect_mask(0, 16, 0, 16), BLOCK_MODELS[static_cast<int>(BlockShape::CUBE)].coverage[0]));
+
+constexpr const BlockModel& get_block_model(BlockShape shape)
+{
+    return BLOCK_MODELS[static_cast<int>(shape)];
+}
+
+}  // namespace rb
@@ -0,0 +1,128 @@
+#include "object.h"
+
+#include "state_cache.h"
+
+namespace rb
+{
+
+#ifdef RB_TRACK_GL_OBJECTS
+namespace utils
+{
+
+struct GLObjectRegistry
+{
+    std::mutex mutex;
+    // Sizes of live objects by type and name
+    std::map<std::pair<GLObjectType, GLuint>, GLsizeiptr> sizes;
+};
+
+static GLObjectRegistry& get_gl_object_registry()
+{
+    static GLObjectRegistry registry;
+    return registry;
+}
+
+static const char* gl_object_type_to_string(GLObjectType type)
+{
+    switch (type)
+    {
+        case GLObjectType::BUFFER:
+            return "buffer";
+
+        case GLObjectType::VERTEX_ARRAY:
+            return "vertex array";
+
+        case GLObjectType::TEXTURE:
+            return "texture";
+
+        case GLObjectType::FRAMEBUFFER:
+            return "framebuffer";
+
+        case GLObjectType::RENDERBUFFER:
+            return "renderbuffer";
+
+        case GLObjectType::PROGRAM:
+            return "program";
+
+        case GLObjectType::QUERY:
+            return "query";
+    }
+
+    return "unknown";
+}
+
+}  // namespace utils
+#endif
+
+void delete_gl_object(GLObjectType type, GLuint id)
+{
+    if (StateCache* state_cache = StateCache::get_current()) state_cache->forget_object(type, id);
+
+    switch (type)
+    {
+        case GLObjectType::BUFFER:
+            glDeleteBuffers(1, &id);
+            break;
+
+        case GLObjectType::VERTEX_ARRAY:
+            glDeleteVertexArrays(1, &id);
+            break;
+
+        case GLObjectType::TEXTURE:
+            glDeleteTextures(1, &id);
+            break;
+
+        case GLObjectType::FRAMEBUFFER:
+            glDeleteFramebuffers(1, &id);
+            break;
+
+        case GLObjectType::RENDERBUFFER:
+            glDeleteRenderbuffers(1, &id);
+            break;
+
+        case GLObjectType::PROGRAM:
+            glDeleteProgram(id);
+            break;
+
+        case GLObjectType::QUERY:
+            glDeleteQueries(1, &id);
+            break;
+    }
+}
+
+void track_gl_object(GLObjectType type, GLuint id, GLsizeiptr size)
+{
+#ifdef RB_TRACK_GL_OBJECTS
+    auto& registry = utils::get_gl_object_registry();
+    const std::lock_guard lock {registry.mutex};
+    registry.sizes[{type, id}] = size;
+#endif
+}
+
+void untrack_gl_object(GLObjectType type, GLuint id)
+{
+#ifdef RB_TRACK_GL_OBJECTS
+    auto& registry = utils::get_gl_object_registry();
+    const std::lock_guard lock {registry.mutex};
+    registry.sizes.erase({type, id});
+#endif
+}
+
+void report_live_gl_objects()
+{
+#ifdef RB_TRACK_GL_OBJECTS
+    auto& registry = utils::get_gl_object_registry();
+    const std::lock_guard lock {registry.mutex};
+
+    GLsizeiptr total_size = 0;
+    for (const auto& [object, size] : registry.sizes)
+    {
+        std::cerr << "Live GL " << utils::gl_object_type_to_string(object.first) << ' ' << object.second << ": " << size << " bytes\n";
+        total_size += size;
+    }
+
+    std::cerr << registry.sizes.size() << " live GL objects holding " << total_size << " bytes\n";
+#endif
+}
+
+}  // namespace rb
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "glad/glad.h"
+
+namespace rb
+{
+
+enum class GLObjectType
+{
+    BUFFER,
+    VERTEX_ARRAY,
+    TEXTURE,
+    FRAMEBUFFER,
+    RENDERBUFFER,
+    PROGRAM,
+    QUERY,
+};
+
+void delete_gl_object(GLObjectType type, GLuint id);
+
+// Leak tracking, these do nothing unless built with RB_TRACK_GL_OBJECTS
+void track_gl_object(GLObjectType type, GLuint id, GLsizeiptr size);
+void untrack_gl_object(GLObjectType type, GLuint id);
+// Prints every tracked GL object that is still alive together with the size of its storage
+void report_live_gl_objects();
+
+// Owns the name of a GL object and deletes the object when destroyed, moving transfers ownership and copying is not possible
+template<GLObjectType TYPE>
+class GLObject
+{
+public:
+    GLObject() = default;
+    explicit GLObject(GLuint id);
+    GLObject(GLObject&& other);
+    GLObject& operator=(GLObject&& other);
+    ~GLObject();
+
+    // Records the size of the storage of the object for leak tracking
+    void set_size(GLsizeiptr size) const;
+
+    GLuint get_id() const;
+
+private:
+    void reset();
+
+    GLuint id = 0;
+};
+
+using BufferObject = GLObject<GLObjectType::BUFFER>;
+using VertexArrayObject = GLObject<GLObjectType::VERTEX_ARRAY>;
+using TextureObject = GLObject<GLObjectType::TEXTURE>;
+using FramebufferObject = GLObject<GLObjectType::FRAMEBUFFER>;
+using RenderbufferObject = GLObject<GLObjectType::RENDERBUFFER>;
+using ProgramObject = GLObject<GLObjectType::PROGRAM>;
+using QueryObject = GLObject<GLObjectType::QUERY>;
+
+template<GLObjectType TYPE>
+GLObject<TYPE>::GLObject(GLuint id) : id(id)
+{
+    track_gl_object(TYPE, id, 0);
+}
+
+template<GLObjectType TYPE>
+GLObject<TYPE>::GLObject(GLObject&& other) : id(std::exchange(other.id, 0))
+{ }
+
+template<GLObjectType TYPE>
+GLObject<TYPE>& GLObject<TYPE>::operator=(GLObject&& other)
+{
+    if (this != &other)
+    {
+        this->reset();
+        this->id = std::exchange(other.id, 0);
+    }
+    return *this;
+}
+
+template<GLObjectType TYPE>
+GLObject<TYPE>::~GLObject()
+{
+    this->reset();
+}
+
+template<GLObjectType TYPE>
+void GLObject<TYPE>::set_size(GLsizeiptr size) const
+{
+    track_gl_object(TYPE, this->id, size);
+}
+
+template<GLObjectType TYPE>
+GLuint GLObject<TYPE>::get_id() const
+{
+    return this->id;
+}
+
+template<GLObjectType TYPE>
+void GLObject<TYPE>::reset()
+{
+    if (!this->id) return;
+
+    untrack_gl_object(TYPE, this->id);
+    delete_gl_object(TYPE, this->id);
+    this->id = 0;
+}
+
+}  // namespace rb
@@ -7,27 +7,81 @@ namespace rb
 
 Framebuffer::Framebuffer(int width, int height)
 {
-    glGenFramebuffers(1, &this->fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, this->fbo);
+    GLuint fbo, color_rbo, depth_rbo;
 
-    glGenRenderbuffers(1, &this->color_rbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, this->color_rbo);
+    if (GLAD_GL_VERSION_4_5)
+    {
+        glCreateFramebuffers(1, &fbo);
+        glCreateRenderbuffers(1, &color_rbo);
+        glCreateRenderbuffers(1, &depth_rbo);
+    }
+    else
+    {
+        glGenFramebuffers(1, &fbo);
+        glGenRenderbuffers(1, &color_rbo);
+        glGenRenderbuffers(1, &depth_rbo);
+    }
+
+    this->fbo = FramebufferObject {fbo};
+    this->color_rbo = RenderbufferObject {color_rbo};
+    this->depth_rbo = RenderbufferObject {depth_rbo};
+    this->color_rbo.set_size(static_cast<GLsizeiptr>(width) * height * 2);
+    this->depth_rbo.set_size(static_cast<GLsizeiptr>(width) * height * 2);
+
+    if (GLAD_GL_VERSION_4_5)
+    {
+        glNamedRenderbufferStorage(color_rbo, GL_RGB565, width, height);
+        glNamedFramebufferRenderbuffer(fbo, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_rbo);
+
+        glNamedRenderbufferStorage(depth_rbo, GL_DEPTH_COMPONENT16, width, height);
+        glNamedFramebufferRenderbuffer(fbo, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_rbo);
+
+        glNamedFramebufferReadBuffer(fbo, GL_COLOR_ATTACHMENT0);
+
+        // Binding is still needed to render into the framebuffer and read it back
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        return;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, color_rbo);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_RGB565, width, height);
-    glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->color_rbo);
+    glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_rbo);
 
-    glGenRenderbuffers(1, &this->depth_rbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, this->depth_rbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_rbo);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, width, height);
-    glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->depth_rbo);
+    glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_rbo);
 
     glReadBuffer(GL_COLOR_ATTACHMENT0);
 }
 
-Framebuffer::~Framebuffer()
+float measure_gpu_frame_time(int num_frames, const std::function<void()>& render_frame)
 {
-    glDeleteFramebuffers(1, &this->fbo);
-    glDeleteRenderbuffers(1, &this->color_rbo);
-    glDeleteRenderbuffers(1, &this->depth_rbo);
+    GLuint id;
+    glGenQueries(1, &id);
+    const QueryObject query {id};
+
+    GLuint64 total_time = 0;
+    for (int frame = 0; frame < num_frames; ++frame)
+    {
+        glBeginQuery(GL_TIME_ELAPSED, query.get_id());
+        render_frame();
+        glEndQuery(GL_TIME_ELAPSED);
+
+        GLuint64 time;
+        glGetQueryObjectui64v(query.get_id(), GL_QUERY_RESULT, &time);
+        total_time += time;
+    }
+
+    return static_cast<float>(total_time) / 1'000'000.0f / num_frames;
+}
+
+std::vector<std::uint8_t> read_color_buffer(int width, int height)
+{
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(width) * height * 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
 }
 
 void write_color_buffer_to_png_file(const char* filepath, int width, int height)
@@ -52,13 +106,10 @@ void write_color_buffer_to_png_file(const char* filepath, int width, int height)
     }
 
     constexpr int num_channels = 4;
-    const int image_size = num_channels * width * height;
 
-    png_byte* png_bytes = new png_byte[image_size];
+    std::vector<std::uint8_t> png_bytes = read_color_buffer(width, height);
     png_byte** png_rows = new png_byte*[height];
 
-    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, png_bytes);
-
     for (int i = 0; i < height; ++i)
         png_rows[height - i - 1] = &png_bytes[i * width * num_channels];
 
@@ -73,7 +124,6 @@ void write_color_buffer_to_png_file(const char* filepath, int width, int height)
 
     std::fclose(file);
 
-    delete[] png_bytes;
     delete[] png_rows;
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "glad/glad.h"
+#include "object.h"
 
 namespace rb
 {
@@ -9,12 +10,17 @@ class Framebuffer
 {
 public:
     Framebuffer(int width, int height);
-    ~Framebuffer();
 
 private:
-    GLuint fbo, color_rbo, depth_rbo;
+    FramebufferObject fbo;
+    RenderbufferObject color_rbo, depth_rbo;
 };
 
+// RGBA8 pixels of the colour buffer, bottom row first
+std::vector<std::uint8_t> read_color_buffer(int width, int height);
 void write_color_buffer_to_png_file(const char* filepath, int width, int height);
 
+// Average GPU time in milliseconds of rendering a frame, measured with timer queries
+float measure_gpu_frame_time(int num_frames, const std::function<void()>& render_frame);
+
 }  // namespace rb
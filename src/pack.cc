@@ -0,0 +1,162 @@
+#include "pack.h"
+
+#include "image.h"
+
+namespace rb
+{
+
+static constexpr char BLOCK_NAMESPACE[] = "minecraft:";
+static constexpr std::array<const char*, 2> TEXTURE_EXTENSIONS = {".png", ".tga"};
+// Blocks whose greyscale textures take the colour of the biome. Bedrock decides this in code rather than in the pack, leaves that are coloured in
+// their image such as those of azaleas and cherries are left out
+static constexpr std::array<const char*, 3> FOLIAGE_BLOCKS = {"leaves", "leaves2", "vine"};
+static constexpr std::array<const char*, 1> GRASS_BLOCKS = {"tallgrass"};
+// Grass blocks only tint their top this way, their sides are overlays and their bottom is dirt
+static constexpr std::array<const char*, 2> GRASS_TOP_BLOCKS = {"grass", "grass_block"};
+
+namespace utils
+{
+
+// Texture entries are either a path, an object with a path, or a list of variants of either kind of which the first one is used
+static const JsonValue* get_texture_entry(const JsonValue& entry)
+{
+    if (entry.type == JsonType::ARRAY) return entry.array.empty() ? nullptr : get_texture_entry(entry.array[0]);
+    return &entry;
+}
+
+static const std::string* get_texture_entry_path(const JsonValue& entry)
+{
+    if (entry.type == JsonType::STRING) return &entry.string;
+
+    const JsonValue* path = entry.type == JsonType::OBJECT ? entry.find("path") : nullptr;
+    return path && path->type == JsonType::STRING ? &path->string : nullptr;
+}
+
+static TextureTint get_block_tint(const std::string& name)
+{
+    if (std::find(FOLIAGE_BLOCKS.begin(), FOLIAGE_BLOCKS.end(), name) != FOLIAGE_BLOCKS.end()) return TextureTint::FOLIAGE;
+    if (std::find(GRASS_BLOCKS.begin(), GRASS_BLOCKS.end(), name) != GRASS_BLOCKS.end()) return TextureTint::GRASS;
+    return TextureTint::NONE;
+}
+
+}  // namespace utils
+
+ResourcePack::ResourcePack(const std::string& path)
+  : path(path), blocks(read_json_file(path + "/blocks.json")), terrain_textures(read_json_file(path + "/textures/terrain_texture.json"))
+{
+    const std::string flipbook_path = path + "/textures/flipbook_textures.json";
+    if (std::filesystem::exists(flipbook_path)) this->flipbook_textures = read_json_file(flipbook_path);
+}
+
+std::optional<CubemapFaceTexturePaths> ResourcePack::get_block_textures(const std::string& block_name) const
+{
+    const std::string name = block_name.starts_with(BLOCK_NAMESPACE) ? block_name.substr(std::strlen(BLOCK_NAMESPACE)) : block_name;
+
+    const JsonValue* block = this->blocks.find(name);
+    if (!block) return std::nullopt;
+
+    // Carried textures are the pre-tinted ones shown in the inventory, the world textures are tinted by the biome instead
+    const JsonValue* faces = block->find("textures");
+    if (!faces) return std::nullopt;
+
+    const TextureTint block_tint = utils::get_block_tint(name);
+    std::array<TextureTint, 6> tints;
+    std::array<TextureAnimation, 6> animations;
+    CubemapFaceTexturePaths texture_paths {
+        this->get_texture_path(faces, "east", block_tint, tints[0], animations[0]),
+        this->get_texture_path(faces, "west", block_tint, tints[1], animations[1]),
+        this->get_texture_path(faces, "up", block_tint, tints[2], animations[2]),
+        this->get_texture_path(faces, "down", block_tint, tints[3], animations[3]),
+        this->get_texture_path(faces, "south", block_tint, tints[4], animations[4]),
+        this->get_texture_path(faces, "north", block_tint, tints[5], animations[5]),
+    };
+    if (tints[2] == TextureTint::NONE && std::find(GRASS_TOP_BLOCKS.begin(), GRASS_TOP_BLOCKS.end(), name) != GRASS_TOP_BLOCKS.end())
+        tints[2] = TextureTint::GRASS;
+    texture_paths.tints = tints;
+    texture_paths.animations = std::move(animations);
+    return texture_paths;
+}
+
+std::string ResourcePack::get_texture_path(
+    const JsonValue* faces, const char* face, TextureTint block_tint, TextureTint& tint, TextureAnimation& animation
+) const
+{
+    tint = TextureTint::NONE;
+
+    // Faces either all use one texture, or name the texture of each face with "side" covering the horizontal faces that are not named themselves
+    const JsonValue* texture_name = faces;
+    if (faces->type == JsonType::OBJECT)
+    {
+        texture_name = faces->find(face);
+        if (!texture_name && std::strcmp(face, "up") && std::strcmp(face, "down")) texture_name = faces->find("side");
+    }
+    if (!texture_name || texture_name->type != JsonType::STRING) return {};
+
+    const JsonValue* texture_data = this->terrain_textures.find("texture_data");
+    const JsonValue* texture = texture_data ? texture_data->find(texture_name->string) : nullptr;
+    const JsonValue* entries = texture ? texture->find("textures") : nullptr;
+    const JsonValue* entry = entries ? utils::get_texture_entry(*entries) : nullptr;
+    const std::string* texture_path = entry ? utils::get_texture_entry_path(*entry) : nullptr;
+
+    // The flipbook names the strip of frames, which is usually the same image
+    const JsonValue* flipbook = texture_path ? this->find_flipbook(texture_name->string) : nullptr;
+    const JsonValue* flipbook_path = flipbook ? flipbook->find("flipbook_texture") : nullptr;
+    if (flipbook_path && flipbook_path->type == JsonType::STRING) texture_path = &flipbook_path->string;
+
+    if (!texture_path)
+    {
+        std::cerr << "Failed to resolve texture: \"" << texture_name->string << "\" is not defined by resource pack \"" << this->path.string() << "\"\n";
+        return {};
+    }
+
+    // Entries with an overlay colour are the ones the game tints through their alpha, such as the top and sides of grass blocks. The colour itself is only
+    // the one of the inventory, the biome provides it in the world
+    const JsonValue* overlay_color = entry->type == JsonType::OBJECT ? entry->find("overlay_color") : nullptr;
+
+    // Paths are given without the extension of the image
+    for (const char* extension : TEXTURE_EXTENSIONS)
+    {
+        const std::filesystem::path image_path = this->path / (*texture_path + extension);
+        if (!std::filesystem::exists(image_path)) continue;
+
+        tint = overlay_color ? TextureTint::GRASS_OVERLAY : block_tint;
+        if (flipbook)
+        {
+            const JsonValue* ticks_per_frame = flipbook->find("ticks_per_frame");
+            if (ticks_per_frame && ticks_per_frame->type == JsonType::NUMBER) animation.ticks_per_frame = static_cast<int>(ticks_per_frame->number);
+
+            // Frames are shown top to bottom unless the flipbook lists them, counting them only takes the header of the image
+            const JsonValue* frames = flipbook->find("frames");
+            if (frames && frames->type == JsonType::ARRAY)
+            {
+                for (const JsonValue& frame : frames->array)
+                    if (frame.type == JsonType::NUMBER) animation.frames.push_back(static_cast<int>(frame.number));
+            }
+            else
+            {
+                int width, height;
+                if (read_image_size(image_path.string(), width, height) && width > 0)
+                    for (int frame = 0; frame < height / width; ++frame)
+                        animation.frames.push_back(frame);
+            }
+        }
+        return image_path.string();
+    }
+
+    std::cerr << "Failed to resolve texture: no image was found for \"" << *texture_path << "\" in resource pack \"" << this->path.string() << "\"\n";
+    return {};
+}
+
+const JsonValue* ResourcePack::find_flipbook(const std::string& texture_name) const
+{
+    if (this->flipbook_textures.type != JsonType::ARRAY) return nullptr;
+
+    for (const JsonValue& flipbook : this->flipbook_textures.array)
+    {
+        const JsonValue* atlas_tile = flipbook.find("atlas_tile");
+        if (atlas_tile && atlas_tile->type == JsonType::STRING && atlas_tile->string == texture_name) return &flipbook;
+    }
+    return nullptr;
+}
+
+}  // namespace rb
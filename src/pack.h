@@ -0,0 +1,32 @@
+#pragma once
+
+#include "cubemap.h"
+#include "json.h"
+
+namespace rb
+{
+
+// Maps block names to the images of their faces through the blocks.json and textures/terrain_texture.json files of a resource pack, without loading any
+// image itself. Faces listed in textures/flipbook_textures.json are animated
+class ResourcePack
+{
+public:
+    ResourcePack(const std::string& path);
+
+    // Returns the image paths of the faces of the block, or nothing if the pack does not define the block. Faces whose texture the pack does not define
+    // are left empty. Faces are tinted by the biome where the game would tint them
+    std::optional<CubemapFaceTexturePaths> get_block_textures(const std::string& block_name) const;
+
+private:
+    std::string get_texture_path(const JsonValue* faces, const char* face, TextureTint block_tint, TextureTint& tint, TextureAnimation& animation) const;
+    // Returns the flipbook animating the texture, or null if it is not animated
+    const JsonValue* find_flipbook(const std::string& texture_name) const;
+
+    std::filesystem::path path;
+    JsonValue blocks;
+    JsonValue terrain_textures;
+    // Optional, as packs that do not animate anything leave it out
+    JsonValue flipbook_textures;
+};
+
+}  // namespace rb
@@ -0,0 +1,68 @@
+#include "pool.h"
+
+namespace rb
+{
+
+ThreadPool::ThreadPool(int num_threads)
+{
+    if (num_threads <= 0) num_threads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+    for (int i = 0; i < num_threads; ++i)
+        this->workers.emplace_back(&ThreadPool::run, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        const std::lock_guard lock {this->mutex};
+        this->is_running = false;
+    }
+    this->tasks_available.notify_all();
+
+    for (auto& worker : this->workers)
+        worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        const std::lock_guard lock {this->mutex};
+        this->tasks.push_back(std::move(task));
+    }
+    this->tasks_available.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock lock {this->mutex};
+    this->tasks_done.wait(lock, [this] { return this->tasks.empty() && this->num_busy_tasks == 0; });
+}
+
+int ThreadPool::get_num_threads() const
+{
+    return this->workers.size();
+}
+
+void ThreadPool::run()
+{
+    std::unique_lock lock {this->mutex};
+
+    while (true)
+    {
+        this->tasks_available.wait(lock, [this] { return !this->tasks.empty() || !this->is_running; });
+        if (!this->is_running) return;
+
+        std::function<void()> task = std::move(this->tasks.front());
+        this->tasks.pop_front();
+        ++this->num_busy_tasks;
+
+        lock.unlock();
+        task();
+        lock.lock();
+
+        --this->num_busy_tasks;
+        this->tasks_done.notify_all();
+    }
+}
+
+}  // namespace rb
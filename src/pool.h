@@ -0,0 +1,32 @@
+#pragma once
+
+namespace rb
+{
+
+// Fixed number of threads running submitted tasks in no particular order
+class ThreadPool
+{
+public:
+    // Uses one thread per hardware thread if num_threads is 0
+    ThreadPool(int num_threads = 0);
+    ~ThreadPool();
+
+    void submit(std::function<void()> task);
+    // Blocks until every submitted task has finished
+    void wait();
+
+    int get_num_threads() const;
+
+private:
+    void run();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable tasks_available;
+    std::condition_variable tasks_done;
+    std::deque<std::function<void()>> tasks;
+    int num_busy_tasks = 0;
+    bool is_running = true;
+};
+
+}  // namespace rb
@@ -0,0 +1,210 @@
+#include "queue.h"
+
+#include "buffer.h"
+#include "constants.h"
+#include "vertex.h"
+
+namespace rb
+{
+
+static constexpr int PASS_BITS = 4;
+static constexpr int PROGRAM_BITS = 12;
+static constexpr int VAO_BITS = 16;
+static constexpr int DEPTH_BITS = 32;
+static_assert(PASS_BITS + PROGRAM_BITS + VAO_BITS + DEPTH_BITS == 64);
+
+static constexpr int RADIX_BITS = 8;
+static constexpr int RADIX_SIZE = 1 << RADIX_BITS;
+
+static constexpr GLsizeiptr INITIAL_STREAM_REGION_SIZE = 1 << 16;
+
+std::uint64_t make_sort_key(RenderPass pass, GLuint program, GLuint vao, float depth)
+{
+    const std::uint64_t quantized_depth = static_cast<std::uint64_t>(glm::clamp(depth, 0.0f, 1.0f) * static_cast<double>((1ull << DEPTH_BITS) - 1));
+
+    // Fields are truncated to their width, packets that collide are still told apart when batching
+    std::uint64_t key = static_cast<std::uint64_t>(pass) & ((1ull << PASS_BITS) - 1);
+    key = key << PROGRAM_BITS | (program & ((1ull << PROGRAM_BITS) - 1));
+    key = key << VAO_BITS | (vao & ((1ull << VAO_BITS) - 1));
+    return key << DEPTH_BITS | quantized_depth;
+}
+
+RenderQueue::RenderQueue(int num_threads) : thread_packets(num_threads), indirect_buffer(create_buffer())
+{
+    if (GLAD_GL_VERSION_4_4) this->stream_buffer.emplace(INITIAL_STREAM_REGION_SIZE);
+}
+
+void RenderQueue::begin_frame()
+{
+    for (auto& packets : this->thread_packets)
+        packets.clear();
+    this->packets.clear();
+
+    if (this->stream_buffer) this->stream_buffer->begin_frame();
+}
+
+void RenderQueue::record(int thread_index, const DrawPacket& packet)
+{
+    this->thread_packets[thread_index].push_back(packet);
+}
+
+void RenderQueue::sort()
+{
+    this->packets.clear();
+    for (const auto& packets : this->thread_packets)
+        this->packets.insert(this->packets.end(), packets.begin(), packets.end());
+
+    const int num_packets = this->packets.size();
+    if (num_packets == 0) return;
+    this->sort_buffer.resize(num_packets);
+
+    // Least significant digit first, every pass is stable so the order of lower digits survives
+    for (int shift = 0; shift < 64; shift += RADIX_BITS)
+    {
+        std::array<int, RADIX_SIZE> offsets {};
+        for (const auto& packet : this->packets)
+            ++offsets[(packet.key >> shift) & (RADIX_SIZE - 1)];
+
+        // Digits shared by every packet, like the pass of a single pass frame, can't change the order
+        if (offsets[(this->packets[0].key >> shift) & (RADIX_SIZE - 1)] == num_packets) continue;
+
+        int offset = 0;
+        for (auto& count : offsets)
+            offset += std::exchange(count, offset);
+
+        for (const auto& packet : this->packets)
+            this->sort_buffer[offsets[(packet.key >> shift) & (RADIX_SIZE - 1)]++] = packet;
+
+        std::swap(this->packets, this->sort_buffer);
+    }
+}
+
+void RenderQueue::submit(StateCache& state_cache)
+{
+    const int num_packets = this->packets.size();
+    this->stats = {};
+    this->stats.num_packets = num_packets;
+
+    const auto get_pass = [](const DrawPacket& packet) { return static_cast<RenderPass>(packet.key >> (PROGRAM_BITS + VAO_BITS + DEPTH_BITS)); };
+    const bool has_depth_prepass = num_packets > 0 && get_pass(this->packets[0]) == RenderPass::DEPTH_PREPASS;
+
+    for (int begin = 0; begin < num_packets;)
+    {
+        const DrawPacket& first = this->packets[begin];
+        if (begin == 0 || get_pass(first) != get_pass(this->packets[begin - 1])) this->begin_pass(get_pass(first), has_depth_prepass, state_cache);
+
+        // Packets drawn with the same state form a batch, which sorting has made contiguous
+        this->commands.clear();
+        int end = begin;
+        for (; end < num_packets; ++end)
+        {
+            const DrawPacket& packet = this->packets[end];
+            if (packet.key >> DEPTH_BITS != first.key >> DEPTH_BITS || packet.program != first.program || packet.vao != first.vao
+                || packet.chunk_origin_buffer != first.chunk_origin_buffer)
+                break;
+            this->commands.push_back(packet.command);
+        }
+
+        state_cache.use_program(first.program);
+        state_cache.bind_vertex_array(first.vao);
+        this->draw_commands(first.vao, first.chunk_origin_buffer);
+
+        ++this->stats.num_batches;
+        begin = end;
+    }
+
+    state_cache.set_depth_mask(true);
+    state_cache.set_color_mask(true);
+}
+
+const RenderQueue::Stats& RenderQueue::get_stats() const
+{
+    return this->stats;
+}
+
+void RenderQueue::begin_pass(RenderPass pass, bool has_depth_prepass, StateCache& state_cache) const
+{
+    switch (pass)
+    {
+        case RenderPass::DEPTH_PREPASS:
+            state_cache.set_color_mask(false);
+            state_cache.set_depth_mask(true);
+            state_cache.set_depth_func(GL_LESS);
+            break;
+
+        case RenderPass::OPAQUE:
+            // After a pre-pass only fragments that won the depth test there are shaded, and depth is already complete
+            state_cache.set_color_mask(true);
+            state_cache.set_depth_mask(!has_depth_prepass);
+            state_cache.set_depth_func(has_depth_prepass ? GL_EQUAL : GL_LESS);
+            break;
+
+        case RenderPass::TRANSLUCENT:
+            // Translucent texels were left out of the depth of the other passes, so they are tested against it like without a pre-pass
+            state_cache.set_color_mask(true);
+            state_cache.set_depth_mask(false);
+            state_cache.set_depth_func(GL_LESS);
+            break;
+    }
+}
+
+void RenderQueue::draw_commands(GLuint vao, GLuint chunk_origin_buffer)
+{
+    const GLsizeiptr commands_size = this->commands.size() * sizeof(DrawElementsIndirectCommand);
+
+    if (this->stream_buffer)
+    {
+        const auto allocation = this->stream_buffer->allocate(commands_size);
+        std::memcpy(allocation.data, this->commands.data(), commands_size);
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, this->stream_buffer->get_id());
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<const void*>(allocation.offset), this->commands.size(), 0);
+        ++this->stats.num_draw_calls;
+        return;
+    }
+
+    if (GLAD_GL_VERSION_4_3)
+    {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, this->indirect_buffer.get_id());
+        this->indirect_buffer.set_size(commands_size);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, commands_size, this->commands.data(), GL_STREAM_DRAW);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, this->commands.size(), 0);
+        ++this->stats.num_draw_calls;
+        return;
+    }
+
+    if (GLAD_GL_VERSION_4_2)
+    {
+        for (const auto& command : this->commands)
+        {
+            glDrawElementsInstancedBaseVertexBaseInstance(
+                GL_TRIANGLES,
+                command.count,
+                GL_UNSIGNED_INT,
+                reinterpret_cast<const void*>(command.first_index * sizeof(Index)),
+                command.instance_count,
+                command.base_vertex,
+                command.base_instance
+            );
+            ++this->stats.num_draw_calls;
+        }
+        return;
+    }
+
+    // Without base instances the per instance attributes are pointed at the chunk origin of every draw instead, the vertex array is already bound
+    for (const auto& command : this->commands)
+    {
+        set_chunk_origin_attributes(vao, chunk_origin_buffer, command.base_instance * sizeof(ChunkOrigin));
+        glDrawElementsInstancedBaseVertex(
+            GL_TRIANGLES,
+            command.count,
+            GL_UNSIGNED_INT,
+            reinterpret_cast<const void*>(command.first_index * sizeof(Index)),
+            command.instance_count,
+            command.base_vertex
+        );
+        ++this->stats.num_draw_calls;
+    }
+}
+
+}  // namespace rb
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "object.h"
+#include "state_cache.h"
+#include "stream.h"
+
+namespace rb
+{
+
+// Passes are drawn in this order
+enum class RenderPass
+{
+    // Optional, lays down the depth of the opaque pass so that it only shades the visible fragment of every pixel
+    DEPTH_PREPASS,
+    OPAQUE,
+    // Blends translucent texels over the opaque pass without writing depth, back to front. Skipped by the pre-pass, so it looks the same with and without
+    TRANSLUCENT,
+};
+
+// Layout mandated by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instance_count;
+    GLuint first_index;
+    GLint base_vertex;
+    GLuint base_instance;
+};
+
+struct DrawPacket
+{
+    std::uint64_t key;
+    GLuint program;
+    GLuint vao;
+    // Buffer of the ChunkOrigins the vertex array reads per instance, which contexts without base instances point the vertex array into per draw
+    GLuint chunk_origin_buffer;
+    DrawElementsIndirectCommand command;
+};
+
+// Orders packets by pass, then program, then vertex array, then depth. Depth is in [0, 1] with 0 being drawn first. All block textures live in one array
+// bound for the whole frame, so the vertex array is the only state left that differs between draws of a program
+std::uint64_t make_sort_key(RenderPass pass, GLuint program, GLuint vao, float depth);
+
+// Collects the draws of a frame so that recording them is decoupled from submitting them. Every recording thread has its own packet list, which keeps its
+// capacity between frames so that recording only allocates while the scene grows
+class RenderQueue
+{
+public:
+    struct Stats
+    {
+        int num_packets;
+        int num_batches;
+        int num_draw_calls;
+    };
+
+    RenderQueue(int num_threads);
+
+    // Clears the packets of the previous frame
+    void begin_frame();
+    // Can be called concurrently as long as every thread passes its own index
+    void record(int thread_index, const DrawPacket& packet);
+    // Merges the packets of all threads and radix sorts them by key
+    void sort();
+    // Draws the sorted packets, binding state only between batches and drawing each batch with as few calls as possible. Depth and colour writes are left
+    // enabled so that the next frame can be cleared
+    void submit(StateCache& state_cache);
+
+    // Counters of the last call to submit
+    const Stats& get_stats() const;
+
+private:
+    void begin_pass(RenderPass pass, bool has_depth_prepass, StateCache& state_cache) const;
+    void draw_commands(GLuint vao, GLuint chunk_origin_buffer);
+
+    std::vector<std::vector<DrawPacket>> thread_packets;
+    std::vector<DrawPacket> packets;
+    std::vector<DrawPacket> sort_buffer;
+
+    // Draw commands are streamed through a persistently mapped buffer where available, falling back to re-specifying a plain buffer every batch
+    std::optional<StreamBuffer> stream_buffer;
+    BufferObject indirect_buffer;
+    std::vector<DrawElementsIndirectCommand> commands;
+    Stats stats {};
+};
+
+}  // namespace rb
@@ -0,0 +1,344 @@
+#include "renderer.h"
+
+namespace rb
+{
+
+// Chunks are drawn at the coarsest level at which a (downsampled) block still covers at least this many pixels
+static constexpr float LOD_MIN_PROJECTED_BLOCK_SIZE = 1.0f;
+
+static constexpr int INITIAL_ARENA_VERTICES = 1 << 18;
+static constexpr int INITIAL_ARENA_INDICES = 1 << 16;
+
+ChunkRenderer::ChunkRenderer(const Config& config, World& world) : config(config), world(world), arena(INITIAL_ARENA_VERTICES, INITIAL_ARENA_INDICES)
+{
+    const glm::ivec3 num_chunks = world.get_num_chunks();
+    this->chunks.resize(num_chunks.x * num_chunks.y * num_chunks.z);
+
+    // Origins never change, so one per chunk level is uploaded up front and selected by the base instance of its draw. Biomes are taken from the world as
+    // they are now
+    std::vector<ChunkOrigin> chunk_origins(this->chunks.size() * NUM_LOD_LEVELS);
+    for (int chunk_index = 0; chunk_index < this->chunks.size(); ++chunk_index)
+        for (int level = 0; level < NUM_LOD_LEVELS; ++level)
+        {
+            const glm::ivec3 chunk_pos = this->get_chunk_pos(chunk_index);
+            chunk_origins[chunk_index * NUM_LOD_LEVELS + level] = {chunk_pos * CHUNK_SIZE, level, static_cast<int>(world.get_biome(chunk_pos))};
+        }
+
+    const GLsizeiptr chunk_origins_size = chunk_origins.size() * sizeof(ChunkOrigin);
+    this->chunk_origin_buffer = create_buffer();
+    this->chunk_origin_buffer.set_size(chunk_origins_size);
+    if (GLAD_GL_VERSION_4_5)
+    {
+        glNamedBufferStorage(this->chunk_origin_buffer.get_id(), chunk_origins_size, chunk_origins.data(), 0);
+    }
+    else
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, this->chunk_origin_buffer.get_id());
+        glBufferData(GL_COPY_WRITE_BUFFER, chunk_origins_size, chunk_origins.data(), GL_STATIC_DRAW);
+    }
+    this->arena.set_chunk_origin_buffer(this->chunk_origin_buffer.get_id());
+
+    if (config.upload_context)
+    {
+        this->upload_worker.emplace(config.upload_context);
+
+        // Buffers can only be replaced once no upload writes to them anymore. Only waiting keeps the arena from being re-entered while it allocates, the
+        // finished uploads are still swapped in by the next call to finish_uploads
+        this->arena.vertices.set_relocation_callback([this] { this->upload_worker->wait_until_idle(); });
+        this->arena.indices.set_relocation_callback([this] { this->upload_worker->wait_until_idle(); });
+    }
+
+    // Started here rather than in the initializer list so that the synchronisation members are constructed first
+    this->worker = std::thread {&ChunkRenderer::run_worker, this};
+}
+
+ChunkRenderer::~ChunkRenderer()
+{
+    {
+        const std::lock_guard lock {this->mutex};
+        this->is_running = false;
+    }
+    this->jobs_available.notify_one();
+    this->worker.join();
+
+    for (const auto& retired : this->retired_geometry)
+        glDeleteSync(retired.fence);
+}
+
+void ChunkRenderer::begin_frame(Camera& camera)
+{
+    this->stats = {};
+    this->view_projection_matrix = camera.get_view_projection_matrix();
+    const Frustum frustum {this->view_projection_matrix};
+    const glm::vec3 world_size {this->world.get_size()};
+
+    {
+        const std::lock_guard lock {this->mutex};
+
+        for (const auto& chunk_pos : this->world.take_dirty_chunks())
+            for (auto& level : this->chunks[this->get_chunk_index(chunk_pos)].levels)
+                ++level.version;
+
+        const glm::ivec3 num_chunks = this->world.get_num_chunks();
+        for (int x = 0; x < num_chunks.x; ++x)
+            for (int y = 0; y < num_chunks.y; ++y)
+                for (int z = 0; z < num_chunks.z; ++z)
+                {
+                    const glm::ivec3 chunk_pos {x, y, z};
+                    Chunk& chunk = this->chunks[this->get_chunk_index(chunk_pos)];
+
+                    const glm::vec3 chunk_min = glm::vec3 {chunk_pos} * static_cast<float>(CHUNK_SIZE);
+                    chunk.is_visible = frustum.intersects_box(chunk_min, glm::min(chunk_min + static_cast<float>(CHUNK_SIZE), world_size));
+                    if (!chunk.is_visible)
+                    {
+                        ++this->stats.num_culled_chunks;
+                        continue;
+                    }
+
+                    ++this->stats.num_visible_chunks;
+
+                    chunk.selected_level = this->select_level(camera, chunk_pos);
+
+                    // Levels are only meshed once they are selected for a visible chunk
+                    ChunkLevel& level = chunk.levels[chunk.selected_level];
+                    if (level.is_queued || level.meshed_version == level.version) continue;
+
+                    this->jobs.push_back({chunk_pos, chunk.selected_level, level.version, this->world.snapshot_chunk(chunk_pos, chunk.selected_level)});
+                    level.is_queued = true;
+                }
+    }
+
+    this->jobs_available.notify_one();
+
+    this->free_retired_geometry();
+    this->process_results();
+    this->finish_uploads(false);
+    this->fence_retired_geometry();
+    this->arena.update_vertex_array();
+}
+
+void ChunkRenderer::wait_until_idle()
+{
+    {
+        std::unique_lock lock {this->mutex};
+        this->jobs_done.wait(lock, [this] { return this->jobs.empty() && this->num_busy_jobs == 0; });
+    }
+
+    this->process_results();
+    this->finish_uploads(true);
+    this->fence_retired_geometry();
+    this->arena.update_vertex_array();
+}
+
+void ChunkRenderer::record(RenderQueue& queue, RenderPass pass, GLuint program, int thread_index, int num_threads) const
+{
+    for (int chunk_index = thread_index; chunk_index < this->chunks.size(); chunk_index += num_threads)
+    {
+        const Chunk& chunk = this->chunks[chunk_index];
+        if (!chunk.is_visible) continue;
+
+        // Fall back to the nearest level that has been meshed while the selected one is still being meshed
+        int level = -1;
+        for (int distance = 0; distance < NUM_LOD_LEVELS && level < 0; ++distance)
+        {
+            if (const int lower = chunk.selected_level - distance; lower >= 0 && chunk.levels[lower].geometry) level = lower;
+            else if (const int higher = chunk.selected_level + distance; higher < NUM_LOD_LEVELS && chunk.levels[higher].geometry) level = higher;
+        }
+
+        if (level < 0) continue;
+        const ChunkGeometry& geometry = *chunk.levels[level].geometry;
+        if (geometry.num_indices == 0) continue;
+
+        // Opaque chunks are drawn front to back so that depth testing rejects as many hidden fragments as possible, translucent ones back to front so
+        // that they blend over what is behind them
+        const glm::vec3 chunk_center = (glm::vec3 {this->get_chunk_pos(chunk_index)} + 0.5f) * static_cast<float>(CHUNK_SIZE);
+        const glm::vec4 clip_pos = this->view_projection_matrix * glm::vec4 {chunk_center, 1.0f};
+        const float chunk_depth = clip_pos.z / clip_pos.w * 0.5f + 0.5f;
+        const float depth = pass == RenderPass::TRANSLUCENT ? 1.0f - chunk_depth : chunk_depth;
+
+        const GLuint vao = this->arena.get_vertex_array();
+        queue.record(
+            thread_index,
+            {
+                make_sort_key(pass, program, vao, depth),
+                program,
+                vao,
+                this->chunk_origin_buffer.get_id(),
+                {
+                    static_cast<GLuint>(geometry.num_indices),
+                    1,
+                    static_cast<GLuint>(this->arena.get_quad_indices_offset()),
+                    this->arena.vertices.get_offset(geometry.vertices),
+                    static_cast<GLuint>(chunk_index * NUM_LOD_LEVELS + level),
+                },
+            }
+        );
+    }
+}
+
+float ChunkRenderer::get_acmr() const
+{
+    int num_triangles = 0;
+    int num_cache_misses = 0;
+
+    // Quads don't share vertices, so drawing them in order misses the cache exactly once per vertex, which no reordering can improve on
+    for (const auto& chunk : this->chunks)
+        for (const auto& level : chunk.levels)
+        {
+            if (!level.geometry) continue;
+
+            num_triangles += level.geometry->num_indices / 3;
+            num_cache_misses += level.geometry->num_indices / 6 * 4;
+        }
+
+    return num_triangles > 0 ? static_cast<float>(num_cache_misses) / num_triangles : 0.0f;
+}
+
+const ChunkRenderer::Stats& ChunkRenderer::get_stats() const
+{
+    return this->stats;
+}
+
+void ChunkRenderer::run_worker()
+{
+    std::unique_lock lock {this->mutex};
+
+    while (true)
+    {
+        this->jobs_available.wait(lock, [this] { return !this->jobs.empty() || !this->is_running; });
+        if (!this->is_running) return;
+
+        Job job = std::move(this->jobs.front());
+        this->jobs.pop_front();
+        ++this->num_busy_jobs;
+
+        lock.unlock();
+        Mesh mesh = mesh_chunk(job.snapshot);
+        lock.lock();
+
+        this->results.push_back({job.chunk_pos, job.level, job.version, std::move(mesh)});
+        --this->num_busy_jobs;
+        this->jobs_done.notify_all();
+    }
+}
+
+void ChunkRenderer::process_results()
+{
+    std::vector<Result> finished_results;
+    {
+        const std::lock_guard lock {this->mutex};
+        std::swap(finished_results, this->results);
+    }
+
+    for (auto& result : finished_results)
+        this->upload(result);
+}
+
+void ChunkRenderer::upload(Result& result)
+{
+    ChunkLevel& level = this->chunks[this->get_chunk_index(result.chunk_pos)].levels[result.level];
+    level.is_queued = false;
+    level.meshed_version = result.version;
+
+    // The new geometry gets its own ranges so that the old one can be drawn until the upload has finished
+    ChunkGeometry geometry;
+
+    if (!result.mesh.vertices.empty())
+    {
+        geometry.vertices = this->arena.vertices.allocate(result.mesh.vertices.size());
+        this->arena.reserve_quads(result.mesh.vertices.size() / 4);
+        geometry.num_indices = result.mesh.vertices.size() / 4 * 6;
+    }
+
+    if (!this->upload_worker)
+    {
+        if (geometry.vertices >= 0) this->arena.vertices.write(geometry.vertices, result.mesh.vertices.data());
+        this->swap_in(result.chunk_pos, result.level, geometry);
+        return;
+    }
+
+    // Offsets are only read once all allocations are done, as allocating may relocate ranges allocated before
+    const GLuint vertex_buffer = this->arena.vertices.get_id();
+    const GLintptr vertices_offset = geometry.vertices >= 0 ? this->arena.vertices.get_offset(geometry.vertices) * sizeof(Vertex) : 0;
+
+    // Empty meshes are submitted as well so that they can't overtake an earlier upload of the same level
+    const int ticket = this->next_upload_ticket++;
+    this->pending_uploads.emplace(ticket, PendingUpload {result.chunk_pos, result.level, geometry});
+    this->upload_worker->submit(
+        ticket,
+        [mesh = std::make_shared<const Mesh>(std::move(result.mesh)), vertex_buffer, vertices_offset]
+        {
+            if (!mesh->vertices.empty()) write_buffer(vertex_buffer, vertices_offset, mesh->vertices.size() * sizeof(Vertex), mesh->vertices.data());
+        }
+    );
+}
+
+void ChunkRenderer::finish_uploads(bool wait)
+{
+    if (!this->upload_worker) return;
+
+    for (const int ticket : this->upload_worker->take_completed(wait))
+    {
+        const auto it = this->pending_uploads.find(ticket);
+        this->swap_in(it->second.chunk_pos, it->second.level, it->second.geometry);
+        this->pending_uploads.erase(it);
+    }
+}
+
+void ChunkRenderer::swap_in(const glm::ivec3& chunk_pos, int level, const ChunkGeometry& geometry)
+{
+    std::optional<ChunkGeometry>& current = this->chunks[this->get_chunk_index(chunk_pos)].levels[level].geometry;
+
+    // Earlier frames may still be drawing the old geometry, so its ranges are only freed after their draws have finished
+    if (current) this->unfenced_geometry.push_back(*current);
+    current = geometry;
+}
+
+void ChunkRenderer::fence_retired_geometry()
+{
+    if (this->unfenced_geometry.empty()) return;
+
+    // Every draw that can read the swapped out geometry was issued by an earlier frame, so a fence placed now follows all of them
+    this->retired_geometry.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), std::exchange(this->unfenced_geometry, {})});
+}
+
+void ChunkRenderer::free_retired_geometry()
+{
+    // Fences are placed in frame order, so the first one that has not signalled ends the search
+    while (!this->retired_geometry.empty())
+    {
+        const RetiredGeometry& retired = this->retired_geometry.front();
+
+        const GLenum status = glClientWaitSync(retired.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) break;
+
+        for (const auto& geometry : retired.geometry)
+            if (geometry.vertices >= 0) this->arena.vertices.free(geometry.vertices);
+
+        glDeleteSync(retired.fence);
+        this->retired_geometry.pop_front();
+    }
+}
+
+int ChunkRenderer::select_level(const Camera& camera, const glm::ivec3& chunk_pos) const
+{
+    const glm::vec3 chunk_center = (glm::vec3 {chunk_pos} + 0.5f) * static_cast<float>(CHUNK_SIZE);
+    const float projected_block_size = camera.get_projected_size(1.0f, chunk_center);
+
+    const float level = glm::ceil(glm::log2(LOD_MIN_PROJECTED_BLOCK_SIZE / projected_block_size));
+    return static_cast<int>(glm::clamp(level, 0.0f, static_cast<float>(NUM_LOD_LEVELS - 1)));
+}
+
+int ChunkRenderer::get_chunk_index(const glm::ivec3& chunk_pos) const
+{
+    const glm::ivec3 num_chunks = this->world.get_num_chunks();
+    return (chunk_pos.x * num_chunks.y + chunk_pos.y) * num_chunks.z + chunk_pos.z;
+}
+
+glm::ivec3 ChunkRenderer::get_chunk_pos(int chunk_index) const
+{
+    const glm::ivec3 num_chunks = this->world.get_num_chunks();
+    return {chunk_index / (num_chunks.y * num_chunks.z), chunk_index / num_chunks.z % num_chunks.y, chunk_index % num_chunks.z};
+}
+
+}  // namespace rb
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "arena.h"
+#include "buffer.h"
+#include "camera.h"
+#include "mesher.h"
+#include "queue.h"
+#include "upload.h"
+#include "world.h"
+
+namespace rb
+{
+
+// Keeps the meshes of the chunks of a world up to date, remeshing edited chunks on a background thread
+class ChunkRenderer
+{
+public:
+    struct Config
+    {
+        // Context shared with the window's context that geometry is uploaded from on a separate thread, or null to upload on the calling thread
+        GLFWwindow* upload_context;
+    };
+
+    struct Stats
+    {
+        int num_visible_chunks;
+        int num_culled_chunks;
+    };
+
+    ChunkRenderer(const Config& config, World& world);
+    ~ChunkRenderer();
+
+    // Culls chunks and selects a level of detail per visible chunk, queues missing or outdated meshes for meshing and swaps in the meshes that finished since
+    // the last frame
+    void begin_frame(Camera& camera);
+    // Blocks until every queued chunk has been remeshed and uploaded
+    void wait_until_idle();
+    // Records a packet of the pass per visible chunk, or only every num_threads-th chunk starting at thread_index so that recording can be split between
+    // threads
+    void record(RenderQueue& queue, RenderPass pass, GLuint program, int thread_index = 0, int num_threads = 1) const;
+
+    // Average number of post-transform vertex cache misses per triangle over all meshes
+    float get_acmr() const;
+    // Counters of the last call to begin_frame
+    const Stats& get_stats() const;
+
+private:
+    struct Job
+    {
+        glm::ivec3 chunk_pos;
+        int level;
+        int version;
+        ChunkSnapshot snapshot;
+    };
+
+    struct Result
+    {
+        glm::ivec3 chunk_pos;
+        int level;
+        int version;
+        Mesh mesh;
+    };
+
+    // Handle into the geometry arena, every chunk is drawn with the shared quad indices
+    struct ChunkGeometry
+    {
+        int vertices = -1;
+        int num_indices = 0;
+    };
+
+    struct ChunkLevel
+    {
+        std::optional<ChunkGeometry> geometry;
+        // Incremented whenever the chunk is edited, the level is up to date when it has been meshed at the current version
+        int version = 0;
+        int meshed_version = -1;
+        bool is_queued = false;
+    };
+
+    struct Chunk
+    {
+        std::array<ChunkLevel, NUM_LOD_LEVELS> levels;
+        int selected_level = 0;
+        bool is_visible = false;
+    };
+
+    // Geometry swapped out by the same frame, its ranges are freed once the fence placed after the draws that could still read them has signalled
+    struct RetiredGeometry
+    {
+        GLsync fence;
+        std::vector<ChunkGeometry> geometry;
+    };
+
+    // Uploads of a chunk level finish in submission order, so the geometry swapped in last is always the newest
+    struct PendingUpload
+    {
+        glm::ivec3 chunk_pos;
+        int level;
+        ChunkGeometry geometry;
+    };
+
+    void run_worker();
+    void process_results();
+    void upload(Result& result);
+    void finish_uploads(bool wait);
+    void swap_in(const glm::ivec3& chunk_pos, int level, const ChunkGeometry& geometry);
+    void fence_retired_geometry();
+    void free_retired_geometry();
+    int select_level(const Camera& camera, const glm::ivec3& chunk_pos) const;
+    int get_chunk_index(const glm::ivec3& chunk_pos) const;
+    glm::ivec3 get_chunk_pos(int chunk_index) const;
+
+    Config config;
+    World& world;
+    std::vector<Chunk> chunks;
+    GeometryArena arena;
+    BufferObject chunk_origin_buffer;
+    glm::mat4 view_projection_matrix {1.0f};
+    Stats stats {};
+
+    // Declared after the arena so that it stops writing to the arena buffers before they are deleted
+    std::optional<UploadWorker> upload_worker;
+    std::unordered_map<int, PendingUpload> pending_uploads;
+    int next_upload_ticket = 0;
+    std::vector<ChunkGeometry> unfenced_geometry;
+    std::deque<RetiredGeometry> retired_geometry;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable jobs_available;
+    std::condition_variable jobs_done;
+    std::deque<Job> jobs;
+    std::vector<Result> results;
+    int num_busy_jobs = 0;
+    bool is_running = true;
+};
+
+}  // namespace rb
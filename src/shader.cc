@@ -1,5 +1,7 @@
 #include "shader.h"
 
+#include "state_cache.h"
+
 namespace rb
 {
 
@@ -42,34 +44,45 @@ Shader::Shader(const char* filepath)
         delete[] source;
 }
 
-Shader::~Shader()
-{
-    glDeleteProgram(this->id);
-}
-
 void Shader::bind() const
 {
-    glUseProgram(this->id);
+    StateCache::get_current()->use_program(this->id.get_id());
 }
 
 void Shader::unbind() const
 {
-    glUseProgram(0);
+    StateCache::get_current()->use_program(0);
 }
 
 void Shader::set_uniform_int(const char* name, int value) const
 {
-    glUniform1i(glGetUniformLocation(this->id, name), value);
+    glUniform1i(glGetUniformLocation(this->id.get_id(), name), value);
+}
+
+void Shader::set_uniform_float(const char* name, float value) const
+{
+    glUniform1f(glGetUniformLocation(this->id.get_id(), name), value);
 }
 
 void Shader::set_uniform_int_array(const char* name, int count, const int* value) const
 {
-    glUniform1iv(glGetUniformLocation(this->id, name), count, value);
+    glUniform1iv(glGetUniformLocation(this->id.get_id(), name), count, value);
 }
 
 void Shader::set_uniform_mat4(const char* name, const glm::mat4& value) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(this->id, name), 1, GL_FALSE, &value[0][0]);
+    glUniformMatrix4fv(glGetUniformLocation(this->id.get_id(), name), 1, GL_FALSE, &value[0][0]);
+}
+
+void Shader::set_uniform_block_binding(const char* name, GLuint binding) const
+{
+    const GLuint index = glGetUniformBlockIndex(this->id.get_id(), name);
+    if (index != GL_INVALID_INDEX) glUniformBlockBinding(this->id.get_id(), index, binding);
+}
+
+GLuint Shader::get_id() const
+{
+    return this->id.get_id();
 }
 
 std::unordered_map<GLenum, char*> Shader::read_from_file(const char* filepath) const
@@ -148,7 +161,7 @@ void Shader::read_inclusion_from_file(char* source, char* inclusion_line) const
 
 void Shader::compile(const std::unordered_map<GLenum, char*>& sources)
 {
-    this->id = glCreateProgram();
+    this->id = ProgramObject {glCreateProgram()};
 
     GLuint shader_ids[MAX_NUM_SHADERS];
     const int num_shaders = sources.size();
@@ -176,32 +189,33 @@ void Shader::compile(const std::unordered_map<GLenum, char*>& sources)
             break;
         }
 
-        glAttachShader(this->id, shader_id);
+        glAttachShader(this->id.get_id(), shader_id);
         shader_ids[i++] = shader_id;
     }
 
-    glLinkProgram(this->id);
+    glLinkProgram(this->id.get_id());
 
     GLint link_status = 0;
-    glGetProgramiv(this->id, GL_LINK_STATUS, &link_status);
+    glGetProgramiv(this->id.get_id(), GL_LINK_STATUS, &link_status);
 
     if (link_status == GL_FALSE)
     {
         GLint info_log_length;
-        glGetProgramiv(this->id, GL_INFO_LOG_LENGTH, &info_log_length);
+        glGetProgramiv(this->id.get_id(), GL_INFO_LOG_LENGTH, &info_log_length);
 
-        std::vector<GLchar> info_log;
-        glGetProgramInfoLog(this->id, info_log_length, &info_log_length, info_log.data());
+        std::vector<GLchar> info_log(info_log_length);
+        glGetProgramInfoLog(this->id.get_id(), info_log_length, &info_log_length, info_log.data());
         std::cerr << "Shader linking error:\n" << info_log.data();
 
-        glDeleteProgram(this->id);
         for (i = 0; i < num_shaders; ++i)
             glDeleteShader(shader_ids[i]);
+        this->id = {};
+        return;
     }
 
     for (i = 0; i < num_shaders; ++i)
     {
-        glDetachShader(this->id, shader_ids[i]);
+        glDetachShader(this->id.get_id(), shader_ids[i]);
         glDeleteShader(shader_ids[i]);
     }
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "glad/glad.h"
+#include "object.h"
 
 namespace rb
 {
@@ -9,21 +10,25 @@ class Shader
 {
 public:
     Shader(const char* filepath);
-    ~Shader();
 
     void bind() const;
     void unbind() const;
 
     void set_uniform_int(const char* name, int value) const;
+    void set_uniform_float(const char* name, float value) const;
     void set_uniform_int_array(const char* name, int count, const int* value) const;
     void set_uniform_mat4(const char* name, const glm::mat4& value) const;
+    // GLSL 330 can't declare the binding of a uniform block, so it is assigned here. Blocks the program does not use are skipped
+    void set_uniform_block_binding(const char* name, GLuint binding) const;
+
+    GLuint get_id() const;
 
 private:
     std::unordered_map<GLenum, char*> read_from_file(const char* filepath) const;
     void read_inclusion_from_file(char* source, char* inclusion_line) const;
     void compile(const std::unordered_map<GLenum, char*>& sources);
 
-    GLuint id;
+    ProgramObject id;
 };
 
 }  // namespace rb
@@ -0,0 +1,194 @@
+#include "state_cache.h"
+
+namespace rb
+{
+
+// GL state belongs to the context current on a thread, so each thread has its own cache
+static thread_local StateCache* current_state_cache = nullptr;
+
+StateCache::StateCache()
+{
+    GLint num_texture_units;
+    glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &num_texture_units);
+    this->textures.resize(num_texture_units);
+
+    this->invalidate();
+    current_state_cache = this;
+}
+
+StateCache::~StateCache()
+{
+    if (current_state_cache == this) current_state_cache = nullptr;
+}
+
+StateCache* StateCache::get_current()
+{
+    return current_state_cache;
+}
+
+void StateCache::use_program(GLuint program)
+{
+    if (this->record(this->program == program)) return;
+
+    this->program = program;
+    glUseProgram(program);
+}
+
+void StateCache::bind_vertex_array(GLuint vao)
+{
+    if (this->record(this->vao == vao)) return;
+
+    this->vao = vao;
+    glBindVertexArray(vao);
+}
+
+void StateCache::bind_texture(int unit, GLenum target, GLuint texture)
+{
+    TextureBinding& binding = this->textures[unit];
+    if (this->record(binding.target == target && binding.texture == texture)) return;
+
+    binding = {target, texture};
+
+    // Direct state access binds to a unit without selecting it first
+    if (GLAD_GL_VERSION_4_5)
+    {
+        glBindTextureUnit(unit, texture);
+        return;
+    }
+
+    // Part of the same call, so it is not counted on its own
+    if (this->active_texture_unit != unit)
+    {
+        this->active_texture_unit = unit;
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+    glBindTexture(target, texture);
+}
+
+void StateCache::set_capability(GLenum capability, bool is_enabled)
+{
+    int* state;
+    switch (capability)
+    {
+        case GL_BLEND:
+            state = &this->capabilities.blend;
+            break;
+
+        case GL_DEPTH_TEST:
+            state = &this->capabilities.depth_test;
+            break;
+
+        case GL_CULL_FACE:
+            state = &this->capabilities.cull_face;
+            break;
+
+        default:
+            std::cerr << "StateCache::set_capability: capability " << capability << " is not tracked\n";
+            return;
+    }
+
+    if (this->record(*state == static_cast<int>(is_enabled))) return;
+
+    *state = is_enabled;
+    if (is_enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+}
+
+void StateCache::set_blend_func(GLenum source_factor, GLenum destination_factor)
+{
+    if (this->record(this->blend_func[0] == source_factor && this->blend_func[1] == destination_factor)) return;
+
+    this->blend_func = {source_factor, destination_factor};
+    glBlendFunc(source_factor, destination_factor);
+}
+
+void StateCache::set_depth_func(GLenum func)
+{
+    if (this->record(this->depth_func == func)) return;
+
+    this->depth_func = func;
+    glDepthFunc(func);
+}
+
+void StateCache::set_depth_mask(bool is_enabled)
+{
+    if (this->record(this->depth_mask == static_cast<int>(is_enabled))) return;
+
+    this->depth_mask = is_enabled;
+    glDepthMask(is_enabled);
+}
+
+void StateCache::set_color_mask(bool is_enabled)
+{
+    if (this->record(this->color_mask == static_cast<int>(is_enabled))) return;
+
+    this->color_mask = is_enabled;
+    glColorMask(is_enabled, is_enabled, is_enabled, is_enabled);
+}
+
+void StateCache::set_cull_face(GLenum face)
+{
+    if (this->record(this->cull_face == face)) return;
+
+    this->cull_face = face;
+    glCullFace(face);
+}
+
+void StateCache::invalidate()
+{
+    this->program = UNKNOWN_NAME;
+    this->vao = UNKNOWN_NAME;
+    this->active_texture_unit = UNKNOWN_FLAG;
+    std::fill(this->textures.begin(), this->textures.end(), TextureBinding {UNKNOWN_ENUM, UNKNOWN_NAME});
+    this->capabilities = {UNKNOWN_FLAG, UNKNOWN_FLAG, UNKNOWN_FLAG};
+    this->blend_func = {UNKNOWN_ENUM, UNKNOWN_ENUM};
+    this->depth_func = UNKNOWN_ENUM;
+    this->depth_mask = UNKNOWN_FLAG;
+    this->color_mask = UNKNOWN_FLAG;
+    this->cull_face = UNKNOWN_ENUM;
+}
+
+void StateCache::forget_object(GLObjectType type, GLuint id)
+{
+    switch (type)
+    {
+        case GLObjectType::VERTEX_ARRAY:
+            if (this->vao == id) this->vao = UNKNOWN_NAME;
+            break;
+
+        case GLObjectType::TEXTURE:
+            for (auto& binding : this->textures)
+                if (binding.texture == id) binding = {UNKNOWN_ENUM, UNKNOWN_NAME};
+            break;
+
+        case GLObjectType::PROGRAM:
+            if (this->program == id) this->program = UNKNOWN_NAME;
+            break;
+
+        default:
+            break;
+    }
+}
+
+void StateCache::begin_frame()
+{
+    this->stats = {};
+}
+
+const StateCache::Stats& StateCache::get_stats() const
+{
+    return this->stats;
+}
+
+bool StateCache::record(bool is_redundant)
+{
+    if (is_redundant)
+        ++this->stats.num_skipped_calls;
+    else
+        ++this->stats.num_issued_calls;
+    return is_redundant;
+}
+
+}  // namespace rb
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "constants.h"
+#include "glad/glad.h"
+#include "object.h"
+
+namespace rb
+{
+
+// Shadows the GL state that changes between draws and skips calls that would not change it. Anything that changes this state without going through the cache
+// has to call invalidate afterwards. A cache is current on the thread that created it, where objects bind through it to be edited
+class StateCache
+{
+public:
+    struct Stats
+    {
+        int num_issued_calls;
+        int num_skipped_calls;
+    };
+
+    StateCache();
+    ~StateCache();
+    StateCache(const StateCache&) = delete;
+    StateCache& operator=(const StateCache&) = delete;
+
+    // The cache of the context on the calling thread, or null if it has none
+    static StateCache* get_current();
+
+    void use_program(GLuint program);
+    void bind_vertex_array(GLuint vao);
+    void bind_texture(int unit, GLenum target, GLuint texture);
+    // Only for capabilities that are tracked: blend, depth test and face culling
+    void set_capability(GLenum capability, bool is_enabled);
+    void set_blend_func(GLenum source_factor, GLenum destination_factor);
+    void set_depth_func(GLenum func);
+    void set_depth_mask(bool is_enabled);
+    // Enables or disables writing all colour channels at once
+    void set_color_mask(bool is_enabled);
+    void set_cull_face(GLenum face);
+
+    // Forgets all tracked state so that the next call of every kind is issued
+    void invalidate();
+    // Forgets the bindings of a deleted object, as its name may be given to a new object that the cache would then consider bound
+    void forget_object(GLObjectType type, GLuint id);
+
+    // Resets the counters
+    void begin_frame();
+    const Stats& get_stats() const;
+
+private:
+    struct TextureBinding
+    {
+        GLenum target;
+        GLuint texture;
+    };
+
+    struct CapabilityState
+    {
+        int blend;
+        int depth_test;
+        int cull_face;
+    };
+
+    bool record(bool is_redundant);
+
+    // Values that no real state can have mark state as unknown
+    static constexpr GLuint UNKNOWN_NAME = ~GLuint {0};
+    static constexpr GLenum UNKNOWN_ENUM = ~GLenum {0};
+    static constexpr int UNKNOWN_FLAG = -1;
+
+    GLuint program;
+    GLuint vao;
+    int active_texture_unit;
+    // One per texture unit the GL supports
+    std::vector<TextureBinding> textures;
+    CapabilityState capabilities;
+    std::array<GLenum, 2> blend_func;
+    GLenum depth_func;
+    int depth_mask;
+    int color_mask;
+    GLenum cull_face;
+
+    Stats stats {};
+};
+
+}  // namespace rb
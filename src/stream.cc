@@ -0,0 +1,133 @@
+#include "stream.h"
+
+#include "buffer.h"
+
+namespace rb
+{
+
+static constexpr GLbitfield STREAM_BUFFER_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+static constexpr GLuint64 FENCE_TIMEOUT = 1'000'000'000;
+
+StreamBuffer::StreamBuffer(GLsizeiptr region_size)
+{
+    this->create(region_size);
+}
+
+StreamBuffer::StreamBuffer(StreamBuffer&& other)
+  : id(std::move(other.id)),
+    region_size(other.region_size),
+    mapping(std::exchange(other.mapping, nullptr)),
+    region(other.region),
+    head(other.head),
+    fences(std::exchange(other.fences, {}))
+{ }
+
+StreamBuffer& StreamBuffer::operator=(StreamBuffer&& other)
+{
+    if (this != &other)
+    {
+        this->destroy();
+        this->id = std::move(other.id);
+        this->region_size = other.region_size;
+        this->mapping = std::exchange(other.mapping, nullptr);
+        this->region = other.region;
+        this->head = other.head;
+        this->fences = std::exchange(other.fences, {});
+    }
+    return *this;
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    this->destroy();
+}
+
+void StreamBuffer::begin_frame()
+{
+    this->fences[this->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    this->region = (this->region + 1) % NUM_STREAM_REGIONS;
+    this->head = 0;
+    this->wait_for_region(this->region);
+}
+
+StreamBuffer::Allocation StreamBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment)
+{
+    GLsizeiptr offset = (this->head + alignment - 1) / alignment * alignment;
+
+    if (offset + size > this->region_size)
+    {
+        // Growing replaces the buffer, which is only safe once the GPU is done with every region
+        const GLsizeiptr new_region_size = std::max(this->region_size * 2, size);
+        this->fences[this->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        this->destroy();
+        this->create(new_region_size);
+        offset = 0;
+    }
+
+    this->head = offset + size;
+
+    const GLintptr buffer_offset = this->region * this->region_size + offset;
+    return {this->mapping + buffer_offset, buffer_offset};
+}
+
+GLuint StreamBuffer::get_id() const
+{
+    return this->id.get_id();
+}
+
+void StreamBuffer::create(GLsizeiptr region_size)
+{
+    this->region_size = region_size;
+    this->region = 0;
+    this->head = 0;
+
+    this->id = create_buffer();
+    this->id.set_size(region_size * NUM_STREAM_REGIONS);
+
+    if (GLAD_GL_VERSION_4_5)
+    {
+        glNamedBufferStorage(this->id.get_id(), region_size * NUM_STREAM_REGIONS, nullptr, STREAM_BUFFER_FLAGS);
+        this->mapping = static_cast<char*>(glMapNamedBufferRange(this->id.get_id(), 0, region_size * NUM_STREAM_REGIONS, STREAM_BUFFER_FLAGS));
+        return;
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, this->id.get_id());
+    glBufferStorage(GL_COPY_WRITE_BUFFER, region_size * NUM_STREAM_REGIONS, nullptr, STREAM_BUFFER_FLAGS);
+    this->mapping = static_cast<char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, region_size * NUM_STREAM_REGIONS, STREAM_BUFFER_FLAGS));
+}
+
+void StreamBuffer::destroy()
+{
+    // Moved from buffers own nothing
+    if (!this->mapping) return;
+
+    for (int region = 0; region < NUM_STREAM_REGIONS; ++region)
+        this->wait_for_region(region);
+
+    if (GLAD_GL_VERSION_4_5)
+    {
+        glUnmapNamedBuffer(this->id.get_id());
+    }
+    else
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, this->id.get_id());
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    }
+    this->id = {};
+    this->mapping = nullptr;
+}
+
+void StreamBuffer::wait_for_region(int region)
+{
+    GLsync& fence = this->fences[region];
+    if (!fence) return;
+
+    while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT) == GL_TIMEOUT_EXPIRED)
+        ;
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+}  // namespace rb
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "object.h"
+
+namespace rb
+{
+
+static constexpr int NUM_STREAM_REGIONS = 3;
+
+// Persistently mapped buffer for data written every frame, split into regions that are used in turn and guarded by fences so that the CPU never writes
+// to a region the GPU is still reading from
+class StreamBuffer
+{
+public:
+    struct Allocation
+    {
+        void* data;
+        GLintptr offset;
+    };
+
+    StreamBuffer(GLsizeiptr region_size);
+    StreamBuffer(StreamBuffer&& other);
+    StreamBuffer& operator=(StreamBuffer&& other);
+    ~StreamBuffer();
+
+    // Fences the region of the previous frame and moves on to the next one, waiting for the GPU if it is still in use
+    void begin_frame();
+    // Bump allocates from the region of the current frame, growing the buffer if the region is full
+    Allocation allocate(GLsizeiptr size, GLsizeiptr alignment = 16);
+
+    GLuint get_id() const;
+
+private:
+    void create(GLsizeiptr region_size);
+    void destroy();
+    void wait_for_region(int region);
+
+    BufferObject id;
+    GLsizeiptr region_size;
+    char* mapping = nullptr;
+
+    int region = 0;
+    GLsizeiptr head = 0;
+    std::array<GLsync, NUM_STREAM_REGIONS> fences {};
+};
+
+}  // namespace rb
@@ -0,0 +1,446 @@
+#include "texture.h"
+
+#include "buffer.h"
+#include "image.h"
+#include "mipmap.h"
+#include "state_cache.h"
+
+namespace rb
+{
+
+namespace utils
+{
+
+// Magenta and black checkerboard, which stands out in any scene
+static void fill_missing_texture(std::uint32_t* pixels, int size)
+{
+    for (int y = 0; y < size; ++y)
+        for (int x = 0; x < size; ++x)
+            pixels[y * size + x] = (x < size / 2) != (y < size / 2) ? 0xFFFF00FF : 0xFF000000;
+}
+
+}  // namespace utils
+
+TextureArray::TextureArray(int size, int capacity, GLsizeiptr memory_budget) : size(size), num_levels(get_num_mip_levels(size))
+{
+    GLint max_gl_layers;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_gl_layers);
+    this->max_layers = std::max(std::min<GLsizeiptr>(memory_budget / get_mip_chain_size(size), max_gl_layers), GLsizeiptr {1});
+
+    this->allocate(std::min(capacity, this->max_layers));
+}
+
+int TextureArray::add_layer()
+{
+    if (this->num_layers == this->max_layers) return -1;
+    if (this->num_layers == this->capacity) this->allocate(std::min(std::max(this->capacity * 2, 1), this->max_layers));
+    return this->num_layers++;
+}
+
+void TextureArray::write_layer(int layer, const void* pixels, int level) const
+{
+    const int level_size = this->size >> level;
+
+    if (GLAD_GL_VERSION_4_5)
+    {
+        glTextureSubImage3D(this->id.get_id(), level, 0, 0, layer, level_size, level_size, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
+    else
+    {
+        StateCache::get_current()->bind_texture(0, GL_TEXTURE_2D_ARRAY, this->id.get_id());
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, level_size, level_size, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
+}
+
+void TextureArray::write_layer_mip_chain(int layer, const std::uint8_t* pixels) const
+{
+    for (int level = 0; level < this->num_levels; ++level)
+    {
+        this->write_layer(layer, pixels, level);
+        const int level_size = this->size >> level;
+        pixels += static_cast<std::size_t>(level_size) * level_size * 4;
+    }
+}
+
+int TextureArray::get_size() const
+{
+    return this->size;
+}
+
+int TextureArray::get_num_levels() const
+{
+    return this->num_levels;
+}
+
+int TextureArray::get_num_layers() const
+{
+    return this->num_layers;
+}
+
+int TextureArray::get_max_layers() const
+{
+    return this->max_layers;
+}
+
+GLuint TextureArray::get_id() const
+{
+    return this->id.get_id();
+}
+
+void TextureArray::allocate(int capacity)
+{
+    GLuint id;
+    if (GLAD_GL_VERSION_4_5)
+        glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &id);
+    else
+        glGenTextures(1, &id);
+    TextureObject texture {id};
+    texture.set_size(static_cast<GLsizeiptr>(get_mip_chain_size(this->size)) * capacity);
+
+    if (GLAD_GL_VERSION_4_5)
+    {
+        glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTextureStorage3D(id, this->num_levels, GL_RGBA8, this->size, this->size, capacity);
+    }
+    else
+    {
+        StateCache::get_current()->bind_texture(0, GL_TEXTURE_2D_ARRAY, id);
+
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, this->num_levels - 1);
+        for (int level = 0; level < this->num_levels; ++level)
+            glTexImage3D(
+                GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, this->size >> level, this->size >> level, capacity, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr
+            );
+    }
+
+    if (this->num_layers > 0 && GLAD_GL_VERSION_4_3)
+    {
+        for (int level = 0; level < this->num_levels; ++level)
+            glCopyImageSubData(
+                this->id.get_id(),
+                GL_TEXTURE_2D_ARRAY,
+                level,
+                0,
+                0,
+                0,
+                id,
+                GL_TEXTURE_2D_ARRAY,
+                level,
+                0,
+                0,
+                0,
+                this->size >> level,
+                this->size >> level,
+                this->num_layers
+            );
+    }
+    else if (this->num_layers > 0)
+    {
+        // Without image copies every level of the old layers is read back into a buffer and uploaded from there, which stays on the GPU. The readback
+        // covers all layers of the old texture, so the buffer is sized for its whole first level and reused for the smaller ones
+        const GLsizeiptr size = static_cast<GLsizeiptr>(this->size) * this->size * 4 * this->capacity;
+        BufferObject pixel_buffer = create_buffer();
+        pixel_buffer.set_size(size);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer.get_id());
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_COPY);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer.get_id());
+
+        StateCache& state_cache = *StateCache::get_current();
+        for (int level = 0; level < this->num_levels; ++level)
+        {
+            const int level_size = this->size >> level;
+
+            state_cache.bind_texture(0, GL_TEXTURE_2D_ARRAY, this->id.get_id());
+            glGetTexImage(GL_TEXTURE_2D_ARRAY, level, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+            state_cache.bind_texture(0, GL_TEXTURE_2D_ARRAY, id);
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, level_size, level_size, this->num_layers, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    this->id = std::move(texture);
+    this->capacity = capacity;
+}
+
+bool TextureCache::Key::operator<(const Key& other) const
+{
+    if (this->path != other.path) return this->path < other.path;
+    if (this->last_write_time != other.last_write_time) return this->last_write_time < other.last_write_time;
+    if (this->frame != other.frame) return this->frame < other.frame;
+    return this->is_alpha_mask < other.is_alpha_mask;
+}
+
+TextureCache::TextureCache(TextureArray& textures, ThreadPool& thread_pool, const TextureBundle* bundle)
+  : textures(textures), thread_pool(thread_pool), bundle(bundle && bundle->is_open() ? bundle : nullptr)
+{
+    if (this->bundle && this->bundle->get_texture_size() != textures.get_size())
+    {
+        std::cerr << "Failed to use texture bundle: its textures are " << this->bundle->get_texture_size() << 'x' << this->bundle->get_texture_size()
+                  << " instead of " << textures.get_size() << 'x' << textures.get_size() << '\n';
+        this->bundle = nullptr;
+    }
+
+    // The placeholder texture is never evicted, so that every texture always resolves to a layer
+    const int size = this->textures.get_size();
+    std::vector<std::uint8_t> pixels(get_mip_chain_size(size));
+    utils::fill_missing_texture(reinterpret_cast<std::uint32_t*>(pixels.data()), size);
+    generate_mip_chain(pixels.data(), size, false);
+
+    this->missing_texture = this->add_texture({}, 0, nullptr, false);
+    Texture& missing_texture = this->entries[this->missing_texture];
+    missing_texture.layer = this->textures.add_layer();
+    this->textures.write_layer_mip_chain(missing_texture.layer, pixels.data());
+}
+
+void TextureCache::begin_frame()
+{
+    ++this->frame;
+}
+
+int TextureCache::load(const std::string& path, int frame, bool is_alpha_mask)
+{
+    // Stands for a texture that is already known to be missing, which has been reported where it was found out
+    if (path.empty()) return this->missing_texture;
+
+    // Strips of frames are not square, so bundles never contain them. Masks that look like cutouts were baked with the cutout filter and are decoded again
+    const int size = this->textures.get_size();
+    const std::uint8_t* mip_chain = this->bundle && frame == 0 ? this->bundle->find(path) : nullptr;
+    if (mip_chain && is_alpha_mask && is_cutout_texture(mip_chain, size)) mip_chain = nullptr;
+
+    if (mip_chain)
+    {
+        const auto it = this->bundled_textures.find(mip_chain);
+        if (it != this->bundled_textures.end())
+        {
+            ++this->stats.num_hits;
+            this->request(it->second);
+            return it->second;
+        }
+
+        const int texture = this->add_texture(path, 0, mip_chain, is_alpha_mask);
+        this->entries[texture].is_cutout = !is_alpha_mask && is_cutout_texture(mip_chain, size);
+        this->entries[texture].is_translucent = !is_alpha_mask && is_translucent_texture(mip_chain, size);
+        this->bundled_textures.emplace(mip_chain, texture);
+        this->make_resident(texture);
+        return texture;
+    }
+
+    std::error_code error;
+    const std::filesystem::path canonical_path = std::filesystem::weakly_canonical(path, error);
+    if (error)
+    {
+        std::cerr << "Failed to load texture: path \"" << path << "\" could not be resolved\n";
+        return this->missing_texture;
+    }
+
+    const std::filesystem::file_time_type last_write_time = std::filesystem::last_write_time(canonical_path, error);
+    if (error)
+    {
+        std::cerr << "Failed to load texture: file \"" << path << "\" was not found\n";
+        return this->missing_texture;
+    }
+
+    const Key key {canonical_path.string(), last_write_time, frame, is_alpha_mask};
+
+    const auto it = this->file_textures.find(key);
+    if (it != this->file_textures.end())
+    {
+        ++this->stats.num_hits;
+        this->request(it->second);
+        return it->second;
+    }
+
+    // Failures are cached as well, so that a broken file is not decoded again for every face using it
+    const int texture = this->add_texture(path, frame, nullptr, is_alpha_mask);
+    this->file_textures.emplace(key, texture);
+    this->make_resident(texture);
+    return texture;
+}
+
+void TextureCache::request(int texture)
+{
+    Texture& entry = this->entries[texture];
+    entry.last_used_frame = this->frame;
+    if (entry.layer < 0) this->make_resident(texture);
+}
+
+void TextureCache::finish_loading()
+{
+    if (this->pending_images.empty()) return;
+
+    const int size = this->textures.get_size();
+    const GLsizeiptr chain_size = get_mip_chain_size(size);
+    const GLsizeiptr staging_size = chain_size * this->pending_images.size();
+
+    // The unpack buffer is the staging arena, so decoded pixels are copied once by the workers and then only by the driver
+    BufferObject staging_buffer = create_buffer();
+    staging_buffer.set_size(staging_size);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging_buffer.get_id());
+
+    std::uint8_t* staging;
+    if (GLAD_GL_VERSION_4_5)
+    {
+        glNamedBufferStorage(staging_buffer.get_id(), staging_size, nullptr, GL_MAP_WRITE_BIT);
+        staging = static_cast<std::uint8_t*>(glMapNamedBufferRange(staging_buffer.get_id(), 0, staging_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    }
+    else
+    {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, staging_size, nullptr, GL_STREAM_DRAW);
+        staging = static_cast<std::uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, staging_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    }
+
+    if (staging == nullptr)
+    {
+        std::cerr << "Failed to load textures: staging buffer of " << staging_size << " bytes could not be mapped\n";
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        this->pending_images.clear();
+        return;
+    }
+
+    // Frames of a flipbook are separate textures from the same file, so the pending images are grouped by file to decode each strip once
+    std::vector<std::vector<std::size_t>> strips;
+    std::unordered_map<std::string_view, std::size_t> strip_indices;
+    for (std::size_t i = 0; i < this->pending_images.size(); ++i)
+    {
+        const auto [it, is_new] = strip_indices.emplace(this->entries[this->pending_images[i].texture].path, strips.size());
+        if (is_new) strips.emplace_back();
+        strips[it->second].push_back(i);
+    }
+
+    for (const auto& strip : strips)
+    {
+        this->thread_pool.submit(
+            [this, &strip, size, chain_size, staging]
+            {
+                // Decoded straight into the staging slots of the layers
+                std::vector<ImageFrame> frames;
+                for (const std::size_t i : strip)
+                    frames.push_back({this->entries[this->pending_images[i].texture].frame, staging + chain_size * i});
+
+                // Reported once, as every frame of the strip fails for the same reason
+                const std::string error = decode_image_frames(this->entries[this->pending_images[strip.front()].texture].path, size, frames);
+                this->pending_images[strip.front()].error = error;
+
+                for (std::size_t j = 0; j < strip.size(); ++j)
+                {
+                    Texture& entry = this->entries[this->pending_images[strip[j]].texture];
+                    std::uint8_t* const pixels = frames[j].pixels;
+                    if (!error.empty()) utils::fill_missing_texture(reinterpret_cast<std::uint32_t*>(pixels), size);
+                    entry.is_cutout = !entry.is_alpha_mask && is_cutout_texture(pixels, size);
+                    entry.is_translucent = !entry.is_alpha_mask && is_translucent_texture(pixels, size);
+                    generate_mip_chain(pixels, size, entry.is_cutout);
+                }
+            }
+        );
+    }
+    this->thread_pool.wait();
+
+    const GLboolean is_intact = GLAD_GL_VERSION_4_5 ? glUnmapNamedBuffer(staging_buffer.get_id()) : glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    if (!is_intact) std::cerr << "Failed to load textures: staging buffer was corrupted while it was mapped\n";
+
+    for (std::size_t i = 0; i < this->pending_images.size(); ++i)
+    {
+        const PendingImage& image = this->pending_images[i];
+        if (!image.error.empty()) std::cerr << "Failed to load texture: " << image.error << '\n';
+
+        // The layer may have been given to another texture since
+        if (this->entries[image.texture].layer == image.layer)
+            this->textures.write_layer_mip_chain(image.layer, reinterpret_cast<const std::uint8_t*>(chain_size * i));
+    }
+
+    // Left bound, it would turn every later pixel upload from client memory into one from the buffer
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    this->pending_images.clear();
+}
+
+int TextureCache::get_layer(int texture) const
+{
+    const int layer = this->entries[texture].layer;
+    return layer >= 0 ? layer : this->entries[this->missing_texture].layer;
+}
+
+bool TextureCache::is_cutout(int texture) const
+{
+    return this->entries[texture].is_cutout;
+}
+
+bool TextureCache::is_translucent(int texture) const
+{
+    return this->entries[texture].is_translucent;
+}
+
+int TextureCache::get_generation() const
+{
+    return this->generation;
+}
+
+const TextureCache::Stats& TextureCache::get_stats() const
+{
+    return this->stats;
+}
+
+int TextureCache::add_texture(const std::string& path, int frame, const std::uint8_t* mip_chain, bool is_alpha_mask)
+{
+    this->entries.push_back({path, frame, mip_chain, is_alpha_mask, false, false, -1, this->frame});
+    return this->entries.size() - 1;
+}
+
+void TextureCache::make_resident(int texture)
+{
+    Texture& entry = this->entries[texture];
+    entry.last_used_frame = this->frame;
+
+    ++this->stats.num_misses;
+
+    const int layer = this->allocate_layer();
+    if (layer < 0)
+    {
+        if (!this->has_exceeded_budget)
+            std::cerr << "Texture memory budget exceeded: all " << this->textures.get_max_layers() << " layers are used by the current frame\n";
+        this->has_exceeded_budget = true;
+        return;
+    }
+
+    entry.layer = layer;
+    ++this->generation;
+
+    if (entry.mip_chain)
+    {
+        ++this->stats.num_bundled;
+        this->textures.write_layer_mip_chain(layer, entry.mip_chain);
+    }
+    else
+    {
+        this->pending_images.push_back({texture, layer, {}});
+    }
+}
+
+int TextureCache::allocate_layer()
+{
+    const int layer = this->textures.add_layer();
+    if (layer >= 0) return layer;
+
+    int victim = -1;
+    for (int texture = 0; texture < this->entries.size(); ++texture)
+    {
+        const Texture& entry = this->entries[texture];
+        if (entry.layer < 0 || texture == this->missing_texture || entry.last_used_frame == this->frame) continue;
+        if (victim < 0 || entry.last_used_frame < this->entries[victim].last_used_frame) victim = texture;
+    }
+    if (victim < 0) return -1;
+
+    ++this->stats.num_evictions;
+    return std::exchange(this->entries[victim].layer, -1);
+}
+
+}  // namespace rb
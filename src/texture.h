@@ -0,0 +1,144 @@
+#pragma once
+
+#include "bundle.h"
+#include "glad/glad.h"
+#include "object.h"
+#include "pool.h"
+
+namespace rb
+{
+
+// Square RGBA textures of one size with full mip chains as layers of a single array texture, so that any number of them can be sampled through one binding.
+// Sampled trilinearly when minified, while magnified texels stay sharp
+class TextureArray
+{
+public:
+    // Layers are limited to the memory budget in bytes, counting their mip chains, as well as to what the GL supports
+    TextureArray(int size, int capacity, GLsizeiptr memory_budget);
+
+    // Returns the index of a new layer with undefined contents, growing the array if it is full, or -1 if the array has reached its maximum number of
+    // layers
+    int add_layer();
+    // Replaces the contents of a mip level of a layer with RGBA pixels, which are an offset into the buffer bound to GL_PIXEL_UNPACK_BUFFER if there is one
+    void write_layer(int layer, const void* pixels, int level = 0) const;
+    // Writes every level of a layer from a mip chain laid out as by generate_mip_chain, which may be an offset into a pixel unpack buffer as well
+    void write_layer_mip_chain(int layer, const std::uint8_t* pixels) const;
+
+    int get_size() const;
+    int get_num_levels() const;
+    int get_num_layers() const;
+    int get_max_layers() const;
+    GLuint get_id() const;
+
+private:
+    // Replaces the texture with one of the given capacity holding the same layers, which without direct state access leaves it bound
+    void allocate(int capacity);
+
+    int size;
+    int num_levels;
+    int max_layers;
+    int capacity = 0;
+    int num_layers = 0;
+    TextureObject id;
+};
+
+// Loads images into layers of a texture array, decoding every file only once no matter how many times it is requested. Images are decoded and get their
+// mip chains generated in batches on a thread pool straight into a mapped pixel unpack buffer, so that the GL thread only has to issue the uploads. The
+// frames of a flipbook strip in a batch share a single decode. Images in a texture bundle are uploaded straight from it instead.
+//
+// Textures are referred to by ids that stay the same while the texture moves between layers. Layers are limited to a memory budget, and once it is used
+// up the texture that was used the longest ago gives up its layer, to be loaded again when it is requested the next time
+class TextureCache
+{
+public:
+    struct Stats
+    {
+        int num_hits;
+        int num_misses;
+        // Misses that were served by the bundle
+        int num_bundled;
+        int num_evictions;
+    };
+
+    // The bundle is optional and ignored if its textures are not the size of the array's layers
+    TextureCache(TextureArray& textures, ThreadPool& thread_pool, const TextureBundle* bundle = nullptr);
+
+    // Stamps textures requested from now on with a new frame, only textures not requested during the current frame can be evicted
+    void begin_frame();
+
+    // Returns the id of the texture, which is the placeholder texture if the image can not be found. The texture is resident and only has to be filled in
+    // by finish_loading. Images of animated textures are vertical strips of square frames, of which every frame is a texture of its own. The alpha of mask
+    // textures such as grass overlays only marks where a tint applies, so they are never cut out and their alpha is filtered like their colours
+    int load(const std::string& path, int frame = 0, bool is_alpha_mask = false);
+    // Marks the texture as used in the current frame and makes it resident again if it was evicted
+    void request(int texture);
+    // Decodes and uploads every image loaded since the last call, images that fail to decode are replaced by the placeholder texture
+    void finish_loading();
+
+    // Layer holding the texture, or the layer of the placeholder texture if it is not resident because the budget is used up by textures of this frame
+    int get_layer(int texture) const;
+    // Whether the texels of the texture are discarded below the alpha cutoff rather than blended, known once finish_loading has loaded it
+    bool is_cutout(int texture) const;
+    // Whether the texture has texels that are blended rather than cut out or opaque, known once finish_loading has loaded it
+    bool is_translucent(int texture) const;
+    // Incremented whenever a texture moves to another layer
+    int get_generation() const;
+    const Stats& get_stats() const;
+
+private:
+    // Files are identified by their canonical path so that different spellings of the same path share a texture, and a file that was modified is loaded
+    // again
+    struct Key
+    {
+        std::string path;
+        std::filesystem::file_time_type last_write_time;
+        int frame;
+        bool is_alpha_mask;
+
+        bool operator<(const Key& other) const;
+    };
+
+    struct Texture
+    {
+        std::string path;
+        int frame;
+        // Mip chain in the bundle, or null if the texture is decoded from its image
+        const std::uint8_t* mip_chain;
+        bool is_alpha_mask = false;
+        bool is_cutout = false;
+        bool is_translucent = false;
+        int layer = -1;
+        int last_used_frame = 0;
+    };
+
+    struct PendingImage
+    {
+        int texture;
+        int layer;
+        // Reported by the GL thread, as the workers would interleave their output
+        std::string error;
+    };
+
+    int add_texture(const std::string& path, int frame, const std::uint8_t* mip_chain, bool is_alpha_mask);
+    void make_resident(int texture);
+    // Returns a free layer, evicting the least recently used texture if the budget is used up, or -1 if every layer is used by the current frame
+    int allocate_layer();
+
+    TextureArray& textures;
+    ThreadPool& thread_pool;
+    const TextureBundle* bundle;
+
+    std::vector<Texture> entries;
+    std::map<Key, int> file_textures;
+    // Bundled images are identified by their mip chain in the bundle, which is looked up without touching the file system
+    std::unordered_map<const std::uint8_t*, int> bundled_textures;
+    std::vector<PendingImage> pending_images;
+    int missing_texture = -1;
+
+    int frame = 0;
+    int generation = 0;
+    bool has_exceeded_budget = false;
+    Stats stats {};
+};
+
+}  // namespace rb
@@ -0,0 +1,105 @@
+#include "upload.h"
+
+namespace rb
+{
+
+static constexpr GLuint64 UPLOAD_FENCE_TIMEOUT = 1'000'000'000;
+
+UploadWorker::UploadWorker(GLFWwindow* context) : context(context)
+{
+    this->worker = std::thread {&UploadWorker::run, this};
+}
+
+UploadWorker::~UploadWorker()
+{
+    {
+        const std::lock_guard lock {this->mutex};
+        this->is_running = false;
+    }
+    this->jobs_available.notify_one();
+    this->worker.join();
+
+    for (const auto& fenced_upload : this->fenced_uploads)
+        glDeleteSync(fenced_upload.fence);
+
+    glfwDestroyWindow(this->context);
+}
+
+void UploadWorker::submit(int ticket, std::function<void()> upload)
+{
+    {
+        const std::lock_guard lock {this->mutex};
+        this->jobs.push_back({ticket, std::move(upload)});
+    }
+    this->jobs_available.notify_one();
+}
+
+std::vector<int> UploadWorker::take_completed(bool wait_for_all)
+{
+    std::unique_lock lock {this->mutex};
+    if (wait_for_all) this->jobs_done.wait(lock, [this] { return this->jobs.empty() && this->num_busy_jobs == 0; });
+
+    std::vector<int> tickets;
+
+    // Uploads finish in the order they were submitted, so the first unfinished one ends the search
+    while (!this->fenced_uploads.empty())
+    {
+        const FencedUpload& fenced_upload = this->fenced_uploads.front();
+
+        GLenum status;
+        do
+            status = glClientWaitSync(fenced_upload.fence, 0, wait_for_all ? UPLOAD_FENCE_TIMEOUT : 0);
+        while (wait_for_all && status == GL_TIMEOUT_EXPIRED);
+
+        if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) break;
+
+        glDeleteSync(fenced_upload.fence);
+        tickets.push_back(fenced_upload.ticket);
+        this->fenced_uploads.pop_front();
+    }
+
+    return tickets;
+}
+
+void UploadWorker::wait_until_idle()
+{
+    std::unique_lock lock {this->mutex};
+    this->jobs_done.wait(lock, [this] { return this->jobs.empty() && this->num_busy_jobs == 0; });
+
+    for (const auto& fenced_upload : this->fenced_uploads)
+        while (glClientWaitSync(fenced_upload.fence, 0, UPLOAD_FENCE_TIMEOUT) == GL_TIMEOUT_EXPIRED)
+            ;
+}
+
+void UploadWorker::run()
+{
+    glfwMakeContextCurrent(this->context);
+
+    std::unique_lock lock {this->mutex};
+
+    while (true)
+    {
+        this->jobs_available.wait(lock, [this] { return !this->jobs.empty() || !this->is_running; });
+        if (!this->is_running) break;
+
+        Job job = std::move(this->jobs.front());
+        this->jobs.pop_front();
+        ++this->num_busy_jobs;
+
+        lock.unlock();
+        job.upload();
+        const GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        // Flushing makes the fence visible to the main context, which can not flush this context's commands itself
+        glFlush();
+        lock.lock();
+
+        this->fenced_uploads.push_back({job.ticket, fence});
+        --this->num_busy_jobs;
+        this->jobs_done.notify_all();
+    }
+
+    lock.unlock();
+    glfwMakeContextCurrent(nullptr);
+}
+
+}  // namespace rb
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "GLFW/glfw3.h"
+#include "glad/glad.h"
+
+namespace rb
+{
+
+// Runs uploads on a thread with its own GL context sharing objects with the main one, fencing every upload so the main thread knows when it is done
+class UploadWorker
+{
+public:
+    // Takes ownership of the context, which has to be created on the main thread
+    UploadWorker(GLFWwindow* context);
+    ~UploadWorker();
+
+    void submit(int ticket, std::function<void()> upload);
+    // Returns the tickets of uploads the GPU has finished in submission order, optionally waiting for every submitted upload first
+    std::vector<int> take_completed(bool wait_for_all);
+    // Waits until the GPU has finished every submitted upload without taking them, so that the written buffers can be read on the calling thread
+    void wait_until_idle();
+
+private:
+    struct Job
+    {
+        int ticket;
+        std::function<void()> upload;
+    };
+
+    struct FencedUpload
+    {
+        int ticket;
+        GLsync fence;
+    };
+
+    void run();
+
+    GLFWwindow* context;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable jobs_available;
+    std::condition_variable jobs_done;
+    std::deque<Job> jobs;
+    std::deque<FencedUpload> fenced_uploads;
+    int num_busy_jobs = 0;
+    bool is_running = true;
+};
+
+}  // namespace rb
@@ -5,9 +5,22 @@ namespace rb
 
 struct Vertex
 {
-    glm::vec3 position;
-    glm::vec3 im_coords;
+    // Relative to the origin of the chunk, in model units of its (possibly downsampled) blocks. A chunk edge spans 257 positions, which needs 16 bits
+    std::array<std::uint16_t, 3> position;
+    // Face of the cubemap of the block texture, which together with the texture index selects the texture array layer
+    std::uint16_t face;
+    glm::vec2 uv;
     float texture_index;
 };
 
+// Placement of the mesh of one level of a chunk, read as an instanced attribute selected by the base instance of its draw
+struct ChunkOrigin
+{
+    // In blocks, kept as integers so that positions stay exact however far the chunk is from the world origin
+    glm::ivec3 position;
+    int level;
+    // Selects the colours of tinted textures from the biome colour map
+    int biome;
+};
+
 }  // namespace rb
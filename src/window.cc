@@ -5,6 +5,23 @@
 namespace rb
 {
 
+namespace utils
+{
+
+static GLFWwindow* create_shared_context(GLFWwindow* window)
+{
+    // The other hints are kept so that the context matches the window's, only visibility is restored to its default for windows created later
+    glfwWindowHint(GLFW_VISIBLE, false);
+    GLFWwindow* context = glfwCreateWindow(1, 1, "", nullptr, window);
+    glfwWindowHint(GLFW_VISIBLE, true);
+
+    if (!context) std::cerr << "Failed to create shared GLFW context!\n";
+
+    return context;
+}
+
+}  // namespace utils
+
 RealtimeWindow::RealtimeWindow(const Config& config) : state({config})
 {
     if (!glfwInit())
@@ -121,6 +138,11 @@ void RealtimeWindow::set_input_mode(int mode, int value) const
     glfwSetInputMode(this->window, mode, value);
 }
 
+GLFWwindow* RealtimeWindow::create_shared_context() const
+{
+    return utils::create_shared_context(this->window);
+}
+
 RealtimeWindow::State& RealtimeWindow::get_state()
 {
     return this->state;
@@ -163,4 +185,9 @@ OffscreenWindow::~OffscreenWindow()
     glfwTerminate();
 }
 
+GLFWwindow* OffscreenWindow::create_shared_context() const
+{
+    return utils::create_shared_context(this->window);
+}
+
 }  // namespace rb
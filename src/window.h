@@ -46,6 +46,9 @@ public:
     void close() const;
     void set_input_mode(int mode, int value) const;
 
+    // Creates an invisible context that shares objects with the window's context, for use on another thread
+    GLFWwindow* create_shared_context() const;
+
     State& get_state();
     const State& get_state() const;
 
@@ -67,6 +70,9 @@ public:
     OffscreenWindow(const Config& config);
     ~OffscreenWindow();
 
+    // Creates an invisible context that shares objects with the window's context, for use on another thread
+    GLFWwindow* create_shared_context() const;
+
 private:
     GLFWwindow* window;
 };
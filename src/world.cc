@@ -5,18 +5,250 @@
 namespace rb
 {
 
+namespace utils
+{
+
+static BlockShape block_shape_from_name(const std::string& name)
+{
+    if (name == "minecraft:air" || name == "minecraft:structure_void")
+        return BlockShape::NONE;
+
+    else if (name.ends_with("_slab") && !name.ends_with("double_slab"))
+        return BlockShape::SLAB;
+
+    else if (name.ends_with("_stairs"))
+        return BlockShape::STAIRS;
+
+    else if (name.ends_with("_fence"))
+        return BlockShape::FENCE;
+
+    else if (name.ends_with("torch"))
+        return BlockShape::TORCH;
+
+    return BlockShape::CUBE;
+}
+
+}  // namespace utils
+
+ChunkSnapshot::ChunkSnapshot(int size) : size(size), blocks((size + 2) * (size + 2) * (size + 2))
+{ }
+
+const Block& ChunkSnapshot::get_block(const glm::ivec3& local_pos) const
+{
+    return this->blocks[this->get_block_index(local_pos)];
+}
+
+void ChunkSnapshot::set_block(const glm::ivec3& local_pos, const Block& block)
+{
+    this->blocks[this->get_block_index(local_pos)] = block;
+}
+
+int ChunkSnapshot::get_size() const
+{
+    return this->size;
+}
+
+int ChunkSnapshot::get_block_index(const glm::ivec3& local_pos) const
+{
+    return ((local_pos.x + 1) * (this->size + 2) + local_pos.y + 1) * (this->size + 2) + local_pos.z + 1;
+}
+
 World::World(const std::string& filepath)
 {
     nbt::NBT root {std::ifstream {filepath, std::ios::binary}};
 
     const auto& size_vector = root["size"].data<nbt::TagInt>();
-    this->size.x = size_vector[0];
-    this->size.y = size_vector[1];
-    this->size.z = size_vector[2];
+    glm::ivec3& size = this->level_sizes[0];
+    size.x = size_vector[0];
+    size.y = size_vector[1];
+    size.z = size_vector[2];
 
     const auto& block_palette = root["structure"]["palette"]["default"]["block_palette"];
 
+    // Entries sharing a name share a material whatever their states, so only textures of materials the structure actually shows are loaded
+    std::vector<Block> palette(block_palette.size());
+    for (int i = 0; i < block_palette.size(); ++i)
+    {
+        const std::string& name = block_palette[i]["name"].data<nbt::TagString>();
+        const BlockShape shape = utils::block_shape_from_name(name);
+        if (shape == BlockShape::NONE) continue;
+
+        const auto material = std::find(this->materials.begin(), this->materials.end(), name);
+        palette[i] = {shape, static_cast<int>(material - this->materials.begin())};
+        if (material == this->materials.end()) this->materials.push_back(name);
+    }
+
+    // Block indices are stored with z varying fastest, followed by y and then x; -1 marks an empty block
+    const auto& block_indices = root["structure"]["block_indices"][0].data<nbt::TagInt>();
+    this->levels[0].resize(size.x * size.y * size.z);
+    for (int i = 0; i < this->levels[0].size(); ++i)
+        if (block_indices[i] >= 0) this->levels[0][i] = palette[block_indices[i]];
+
+    for (int level = 1; level < NUM_LOD_LEVELS; ++level)
+    {
+        const glm::ivec3& level_size = this->level_sizes[level] = (this->level_sizes[level - 1] + glm::ivec3 {1}) / 2;
+        this->levels[level].resize(level_size.x * level_size.y * level_size.z);
+
+        for (int x = 0; x < level_size.x; ++x)
+            for (int y = 0; y < level_size.y; ++y)
+                for (int z = 0; z < level_size.z; ++z)
+                    this->update_lod_block({x, y, z}, level);
+    }
+
+    const glm::ivec3 num_chunks = this->get_num_chunks();
+    this->chunk_biomes.resize(num_chunks.x * num_chunks.y * num_chunks.z, Biome::PLAINS);
+    for (int x = 0; x < num_chunks.x; ++x)
+        for (int y = 0; y < num_chunks.y; ++y)
+            for (int z = 0; z < num_chunks.z; ++z)
+                this->dirty_chunks.push_back({x, y, z});
+
     std::cout << "Successfully loaded NBT!\n";
 }
 
+const Block& World::get_block(const glm::ivec3& pos, int level) const
+{
+    return this->levels[level][this->get_block_index(pos, level)];
+}
+
+void World::set_block(const glm::ivec3& pos, const Block& block)
+{
+    Block& old_block = this->levels[0][this->get_block_index(pos, 0)];
+    const glm::ivec3 chunk_pos = pos / CHUNK_SIZE;
+
+    this->mark_chunk_dirty(chunk_pos);
+    this->mark_neighbours_dirty(pos, 0, old_block, block);
+    old_block = block;
+
+    // Coarser levels share the chunk grid, so a changed level block on the border of its chunk can uncover faces in the next chunk at that level
+    for (int level = 1; level < NUM_LOD_LEVELS; ++level)
+    {
+        const glm::ivec3 level_pos = pos >> level;
+        const Block old_level_block = this->get_block(level_pos, level);
+        this->update_lod_block(level_pos, level);
+        this->mark_neighbours_dirty(level_pos, level, old_level_block, this->get_block(level_pos, level));
+    }
+}
+
+bool World::contains(const glm::ivec3& pos, int level) const
+{
+    const glm::ivec3& size = this->level_sizes[level];
+    return pos.x >= 0 && pos.y >= 0 && pos.z >= 0 && pos.x < size.x && pos.y < size.y && pos.z < size.z;
+}
+
+Biome World::get_biome(const glm::ivec3& chunk_pos) const
+{
+    return this->chunk_biomes[this->get_chunk_index(chunk_pos)];
+}
+
+void World::set_biome(const glm::ivec3& chunk_pos, Biome biome)
+{
+    this->chunk_biomes[this->get_chunk_index(chunk_pos)] = biome;
+}
+
+const std::vector<std::string>& World::get_materials() const
+{
+    return this->materials;
+}
+
+const glm::ivec3& World::get_size() const
+{
+    return this->level_sizes[0];
+}
+
+glm::ivec3 World::get_num_chunks() const
+{
+    return (this->level_sizes[0] + glm::ivec3 {CHUNK_SIZE - 1}) / CHUNK_SIZE;
+}
+
+ChunkSnapshot World::snapshot_chunk(const glm::ivec3& chunk_pos, int level) const
+{
+    const int size = CHUNK_SIZE >> level;
+    const glm::ivec3 origin = chunk_pos * size;
+    ChunkSnapshot snapshot {size};
+
+    for (int x = -1; x <= size; ++x)
+        for (int y = -1; y <= size; ++y)
+            for (int z = -1; z <= size; ++z)
+            {
+                const glm::ivec3 local_pos {x, y, z};
+                if (this->contains(origin + local_pos, level)) snapshot.set_block(local_pos, this->get_block(origin + local_pos, level));
+            }
+
+    return snapshot;
+}
+
+std::vector<glm::ivec3> World::take_dirty_chunks()
+{
+    return std::exchange(this->dirty_chunks, {});
+}
+
+int World::get_block_index(const glm::ivec3& pos, int level) const
+{
+    const glm::ivec3& size = this->level_sizes[level];
+    return (pos.x * size.y + pos.y) * size.z + pos.z;
+}
+
+int World::get_chunk_index(const glm::ivec3& chunk_pos) const
+{
+    const glm::ivec3 num_chunks = this->get_num_chunks();
+    return (chunk_pos.x * num_chunks.y + chunk_pos.y) * num_chunks.z + chunk_pos.z;
+}
+
+void World::update_lod_block(const glm::ivec3& pos, int level)
+{
+    std::array<Block, 8> children;
+    int num_children = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        const glm::ivec3 child_pos = pos * 2 + glm::ivec3 {i & 1, (i >> 1) & 1, (i >> 2) & 1};
+        if (this->contains(child_pos, level - 1)) children[num_children++] = this->get_block(child_pos, level - 1);
+    }
+
+    // The most common material wins, with empty space only winning if it fills more than half of the volume
+    Block majority;
+    int majority_count = 0;
+    int num_solid_children = 0;
+
+    for (int i = 0; i < num_children; ++i)
+    {
+        if (children[i].shape == BlockShape::NONE) continue;
+        ++num_solid_children;
+
+        const int count = std::count_if(
+            children.begin(),
+            children.begin() + num_children,
+            [&children, i](const Block& child) { return child.shape != BlockShape::NONE && child.texture_index == children[i].texture_index; }
+        );
+        if (count > majority_count)
+        {
+            majority = {BlockShape::CUBE, children[i].texture_index};
+            majority_count = count;
+        }
+    }
+
+    this->levels[level][this->get_block_index(pos, level)] = num_solid_children * 2 >= num_children ? majority : Block {};
+}
+
+void World::mark_neighbours_dirty(const glm::ivec3& pos, int level, const Block& old_block, const Block& new_block)
+{
+    const int chunk_size = CHUNK_SIZE >> level;
+    const glm::ivec3 chunk_pos = pos / chunk_size;
+
+    // A neighbouring chunk only needs remeshing if the shape of the face between the two blocks changed
+    const BlockModel& old_model = get_block_model(old_block.shape);
+    const BlockModel& new_model = get_block_model(new_block.shape);
+    for (int face = 0; face < NUM_FACES; ++face)
+    {
+        const glm::ivec3 neighbour_pos = pos + FACE_DIRECTIONS[face];
+        if (!this->contains(neighbour_pos, level) || neighbour_pos / chunk_size == chunk_pos) continue;
+        if (old_model.coverage[face] != new_model.coverage[face]) this->mark_chunk_dirty(neighbour_pos / chunk_size);
+    }
+}
+
+void World::mark_chunk_dirty(const glm::ivec3& chunk_pos)
+{
+    if (std::find(this->dirty_chunks.begin(), this->dirty_chunks.end(), chunk_pos) == this->dirty_chunks.end()) this->dirty_chunks.push_back(chunk_pos);
+}
+
 }  // namespace rb
@@ -1,15 +1,71 @@
 #pragma once
 
+#include "biome.h"
+#include "constants.h"
+#include "model.h"
+
 namespace rb
 {
 
+struct Block
+{
+    BlockShape shape = BlockShape::NONE;
+    int texture_index = 0;
+};
+
+// Blocks of one chunk plus a one block wide border of its neighbours
+class ChunkSnapshot
+{
+public:
+    ChunkSnapshot(int size);
+
+    const Block& get_block(const glm::ivec3& local_pos) const;
+    void set_block(const glm::ivec3& local_pos, const Block& block);
+
+    int get_size() const;
+
+private:
+    int get_block_index(const glm::ivec3& local_pos) const;
+
+    int size;
+    std::vector<Block> blocks;
+};
+
 class World
 {
 public:
     World(const std::string& filepath);
 
+    // Level 0 holds the blocks themselves, every further level halves the resolution of the previous one
+    const Block& get_block(const glm::ivec3& pos, int level = 0) const;
+    void set_block(const glm::ivec3& pos, const Block& block);
+    bool contains(const glm::ivec3& pos, int level = 0) const;
+
+    // Structures do not store biomes, so every chunk is in the plains until told otherwise. Renderers take the biomes when they are created
+    Biome get_biome(const glm::ivec3& chunk_pos) const;
+    void set_biome(const glm::ivec3& chunk_pos, Biome biome);
+
+    // Names of the blocks of the structure without air, texture indices of blocks index this list
+    const std::vector<std::string>& get_materials() const;
+    const glm::ivec3& get_size() const;
+    glm::ivec3 get_num_chunks() const;
+    ChunkSnapshot snapshot_chunk(const glm::ivec3& chunk_pos, int level = 0) const;
+
+    // Returns the chunks whose meshes are out of date and clears the list
+    std::vector<glm::ivec3> take_dirty_chunks();
+
 private:
-    glm::ivec3 size;
+    int get_block_index(const glm::ivec3& pos, int level) const;
+    int get_chunk_index(const glm::ivec3& chunk_pos) const;
+    void update_lod_block(const glm::ivec3& pos, int level);
+    void mark_neighbours_dirty(const glm::ivec3& pos, int level, const Block& old_block, const Block& new_block);
+    void mark_chunk_dirty(const glm::ivec3& chunk_pos);
+
+    std::array<glm::ivec3, NUM_LOD_LEVELS> level_sizes;
+    std::array<std::vector<Block>, NUM_LOD_LEVELS> levels;
+    std::vector<glm::ivec3> dirty_chunks;
+    std::vector<std::string> materials;
+    std::vector<Biome> chunk_biomes;
 };
 
 }  // namespace rb